@@ -8,6 +8,7 @@
 #include <future>
 #include <filesystem>
 #include <variant>
+#include <functional>
 #include "interfaces.h"
 #include "cipher_modes.h"
 #include "block_operations.h"
@@ -86,6 +87,10 @@ namespace crypto {
             virtual ~IProcessMode() = default;
 
             virtual std::vector<uint8_t> operator()(const std::vector<uint8_t> &padded_data) const = 0;
+
+        protected:
+            // Делит blocks_count блоков на диапазоны [start_block, end_block) и обрабатывает их параллельно
+            void parallel_for(size_t blocks_count, const std::function<void(size_t, size_t)> &task) const;
         };
 
         class ProcessECB final : public IProcessMode {
@@ -163,6 +168,8 @@ namespace crypto {
 
         class ProcessCTR final : public IProcessMode {
             mutable std::vector<uint8_t> _counter;
+            // Число счётчиков, шифруемых одним пакетом
+            static constexpr size_t _counters_per_batch = 64;
 
             void add_counter(std::vector<uint8_t> &counter, uint64_t val) const;
 
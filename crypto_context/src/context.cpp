@@ -17,39 +17,24 @@ namespace crypto {
         _block_size = _algorithm->get_block_size();
     }
 
-    std::vector<uint8_t> CryptoContext::ProcessECB::operator()(const std::vector<uint8_t> &padded_data) const {
-        auto blocks = block::split_blocks(padded_data, _block_size);
-        const unsigned max_threads = (blocks.size() + _min_blocks_per_thread - 1) / _min_blocks_per_thread;
+    void CryptoContext::IProcessMode::parallel_for(size_t blocks_count,
+                                                   const std::function<void(size_t, size_t)> &task) const {
+        if (blocks_count == 0) return;
+        const unsigned max_threads = (blocks_count + _min_blocks_per_thread - 1) / _min_blocks_per_thread;
         const unsigned hardware_threads = std::thread::hardware_concurrency();
         const auto num_threads = std::min(hardware_threads != 0 ? hardware_threads : 2, max_threads);
-        const size_t blocks_per_thread = blocks.size() / num_threads;
-        std::vector<std::future<std::vector<std::vector<uint8_t> > > > futures(num_threads);
+        const size_t blocks_per_thread = blocks_count / num_threads;
+        std::vector<std::future<void> > futures(num_threads);
         for (unsigned i = 0; i < num_threads; ++i) {
             const auto policy = i == 0 ? std::launch::deferred : std::launch::async;
             const size_t start_block = i * blocks_per_thread;
-            const size_t end_block = i == num_threads - 1 ? blocks.size() : start_block + blocks_per_thread;
-
-            futures[i] = std::async(policy, [this, &blocks, start_block, end_block] {
-                std::vector<std::vector<uint8_t> > result;
-                result.reserve(end_block - start_block);
-                for (auto j = start_block; j < end_block; ++j) {
-                    if (_encrypt) result.push_back(_algorithm->encrypt(blocks[j]));
-                    else result.push_back(_algorithm->decrypt(blocks[j]));
-                }
-                return result;
-            });
+            const size_t end_block = i == num_threads - 1 ? blocks_count : start_block + blocks_per_thread;
+            futures[i] = std::async(policy, task, start_block, end_block);
         }
-        std::vector<std::vector<uint8_t> > result_blocks;
-        result_blocks.reserve(blocks.size());
         std::exception_ptr exception{nullptr};
-        auto pos_it = result_blocks.begin();
-        for (auto i = 0; i < num_threads; ++i) {
+        for (auto &future: futures) {
             try {
-                auto fut_res = futures[i].get();;
-                if (!exception) {
-                    result_blocks.insert(result_blocks.end(), fut_res.begin(), fut_res.end());
-                }
-                pos_it += static_cast<ptrdiff_t>(fut_res.size());
+                future.get();
             }
             catch (...) {
                 exception = std::current_exception();
@@ -58,7 +43,19 @@ namespace crypto {
         if (exception) {
             std::rethrow_exception(exception);
         }
-        return block::join_blocks(result_blocks);
+    }
+
+    std::vector<uint8_t> CryptoContext::ProcessECB::operator()(const std::vector<uint8_t> &padded_data) const {
+        if (padded_data.size() % _block_size != 0)
+            throw std::invalid_argument("Data length must be multiple of block size");
+        std::vector<uint8_t> result(padded_data.size());
+        parallel_for(padded_data.size() / _block_size, [this, &padded_data, &result](size_t start, size_t end) {
+            const auto input = std::span(padded_data).subspan(start * _block_size, (end - start) * _block_size);
+            const auto output = std::span(result).subspan(start * _block_size, (end - start) * _block_size);
+            if (_encrypt) _algorithm->encrypt_blocks(input, output);
+            else _algorithm->decrypt_blocks(input, output);
+        });
+        return result;
     }
 
     std::vector<uint8_t> CryptoContext::ProcessPCBC::operator()(const std::vector<uint8_t> &padded_data) const {
@@ -193,53 +190,24 @@ namespace crypto {
     }
 
     std::vector<uint8_t> CryptoContext::ProcessCBC::decrypt(const std::vector<uint8_t> &padded_data) const {
-        auto blocks = block::split_blocks(padded_data, _block_size);
-        const unsigned max_threads = (blocks.size() + _min_blocks_per_thread - 1) / _min_blocks_per_thread;
-        const unsigned hardware_threads = std::thread::hardware_concurrency();
-        const auto num_threads = std::min(hardware_threads != 0 ? hardware_threads : 2, max_threads);
-        const size_t blocks_per_thread = blocks.size() / num_threads;
-        std::vector<std::future<std::vector<std::vector<uint8_t> > > > futures(num_threads);
-        for (unsigned i = 0; i < num_threads; ++i) {
-            const auto policy = i == 0 ? std::launch::deferred : std::launch::async;
-            const size_t start_block = i * blocks_per_thread;
-            const size_t end_block = i == num_threads - 1 ? blocks.size() : start_block + blocks_per_thread;
-
-            futures[i] = std::async(policy, [this, &blocks, start_block, end_block] {
-                std::vector<std::vector<uint8_t> > result;
-                result.reserve(end_block - start_block);
-                for (auto j = start_block; j < end_block; ++j) {
-                    auto decrypted = _algorithm->decrypt(blocks[j]);
-                    for (auto k = 0; k < _block_size; ++k) {
-                        decrypted[k] ^= (j == 0 ? _init_vec[k] : blocks[j - 1][k]);
-                    }
-                    result.push_back(std::move(decrypted));
+        if (padded_data.size() % _block_size != 0)
+            throw std::invalid_argument("Data length must be multiple of block size");
+        std::vector<uint8_t> result(padded_data.size());
+        parallel_for(padded_data.size() / _block_size, [this, &padded_data, &result](size_t start, size_t end) {
+            const auto input = std::span(padded_data).subspan(start * _block_size, (end - start) * _block_size);
+            const auto output = std::span(result).subspan(start * _block_size, (end - start) * _block_size);
+            _algorithm->decrypt_blocks(input, output);
+            for (auto j = start; j < end; ++j) {
+                const uint8_t *prev = j == 0 ? _init_vec.data() : padded_data.data() + (j - 1) * _block_size;
+                for (size_t k = 0; k < _block_size; ++k) {
+                    result[j * _block_size + k] ^= prev[k];
                 }
-                return result;
-            });
-        }
-        std::vector<std::vector<uint8_t> > result_blocks;
-        result_blocks.reserve(blocks.size());
-        std::exception_ptr exception{nullptr};
-        auto pos_it = result_blocks.begin();
-        for (auto i = 0; i < num_threads; ++i) {
-            try {
-                auto fut_res = futures[i].get();;
-                if (!exception) {
-                    result_blocks.insert(result_blocks.end(),
-                                         fut_res.begin(),
-                                         fut_res.end());
-                }
-                pos_it += static_cast<ptrdiff_t>(fut_res.size());
-            }
-            catch (...) {
-                exception = std::current_exception();
             }
+        });
+        if (!padded_data.empty()) {
+            _init_vec.assign(padded_data.end() - static_cast<ptrdiff_t>(_block_size), padded_data.end());
         }
-        if (exception) {
-            std::rethrow_exception(exception);
-        }
-        _init_vec = std::move(blocks.back());
-        return block::join_blocks(result_blocks);
+        return result;
     }
 
     std::vector<uint8_t> CryptoContext::ProcessOFB::operator()(const std::vector<uint8_t> &padded_data) const {
@@ -276,54 +244,30 @@ namespace crypto {
     }
 
     std::vector<uint8_t> CryptoContext::ProcessCTR::operator()(const std::vector<uint8_t> &padded_data) const {
-        auto blocks = block::split_blocks(padded_data, _block_size);
-        const unsigned max_threads = (blocks.size() + _min_blocks_per_thread - 1) / _min_blocks_per_thread;
-        const unsigned hardware_threads = std::thread::hardware_concurrency();
-        const auto num_threads = std::min(hardware_threads != 0 ? hardware_threads : 2, max_threads);
-        const size_t blocks_per_thread = blocks.size() / num_threads;
-        std::vector<std::future<std::vector<std::vector<uint8_t> > > > futures(num_threads);
-        for (unsigned i = 0; i < num_threads; ++i) {
-            const auto policy = i == 0 ? std::launch::deferred : std::launch::async;
-            const size_t start_block = i * blocks_per_thread;
-            const size_t end_block = i == num_threads - 1 ? blocks.size() : start_block + blocks_per_thread;
-
-            futures[i] = std::async(policy, [this, &blocks, start_block, end_block] {
-                std::vector<std::vector<uint8_t> > result;
-                result.reserve(end_block - start_block);
-                auto counter = _counter;
-                add_counter(counter, start_block);
-                for (auto j = start_block; j < end_block; ++j) {
-                    auto encrypted = _algorithm->encrypt(counter);
-                    for (auto k = 0; k < _block_size; ++k) {
-                        encrypted[k] ^= blocks[j][k];
-                    }
-                    result.push_back(std::move(encrypted));
+        if (padded_data.size() % _block_size != 0)
+            throw std::invalid_argument("Data length must be multiple of block size");
+        const size_t blocks_count = padded_data.size() / _block_size;
+        std::vector<uint8_t> result(padded_data.size());
+        parallel_for(blocks_count, [this, &padded_data, &result](size_t start, size_t end) {
+            auto counter = _counter;
+            add_counter(counter, start);
+            std::vector<uint8_t> counters(std::min(end - start, _counters_per_batch) * _block_size);
+            for (auto batch_start = start; batch_start < end; batch_start += _counters_per_batch) {
+                const size_t batch_bytes = std::min(end - batch_start, _counters_per_batch) * _block_size;
+                const auto batch = std::span(counters).first(batch_bytes);
+                for (size_t offset = 0; offset < batch_bytes; offset += _block_size) {
+                    std::ranges::copy(counter, batch.begin() + static_cast<ptrdiff_t>(offset));
                     add_counter(counter, 1);
                 }
-                return result;
-            });
-        }
-        std::vector<std::vector<uint8_t> > result_blocks;
-        result_blocks.reserve(blocks.size());
-        std::exception_ptr exception{nullptr};
-        auto pos_it = result_blocks.begin();
-        for (auto i = 0; i < num_threads; ++i) {
-            try {
-                auto fut_res = futures[i].get();;
-                if (!exception) {
-                    result_blocks.insert(result_blocks.end(), fut_res.begin(), fut_res.end());
+                _algorithm->encrypt_blocks(batch, batch);
+                const size_t data_offset = batch_start * _block_size;
+                for (size_t k = 0; k < batch_bytes; ++k) {
+                    result[data_offset + k] = padded_data[data_offset + k] ^ batch[k];
                 }
-                pos_it += static_cast<ptrdiff_t>(fut_res.size());
             }
-            catch (...) {
-                exception = std::current_exception();
-            }
-        }
-        if (exception) {
-            std::rethrow_exception(exception);
-        }
-        add_counter(_counter, blocks.size());
-        return block::join_blocks(result_blocks);
+        });
+        add_counter(_counter, blocks_count);
+        return result;
     }
 
     void CryptoContext::ProcessRandomDelta::add_delta(std::vector<uint8_t> &counter, size_t count) const {
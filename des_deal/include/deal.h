@@ -4,6 +4,7 @@
 #include "interfaces.h"
 #include "feistel_network.h"
 #include "unordered_map"
+#include "feistel_engine.h"
 #include "des.h"
 
 
@@ -22,17 +23,56 @@ namespace crypto::deal {
     class DEALKeyExpansion final : public IKeyExpansion {
     public:
         std::vector<std::vector<uint8_t> > generate_round_keys(std::span<const uint8_t> input_key) override;
+
+        // Раундовые ключи DEAL как 64-битные слова без аллокаций; возвращает число раундов
+        static size_t expand(std::span<const uint8_t> input_key, std::array<uint64_t, 8> &round_keys);
+    };
+
+
+    /**
+     * Раундовая функция DEAL: DES с раундовым ключом DEAL над 64-битной половиной блока
+     */
+    struct DEALRoundFunction {
+        [[nodiscard]] uint64_t operator()(uint64_t half, const des::RoundKeys &round_keys) const noexcept {
+            return des::encrypt_block(half, round_keys);
+        }
+
+        // Все половины группы шифруются одним чередующимся проходом DES
+        template<size_t Lanes>
+        [[nodiscard]] std::array<uint64_t, Lanes> operator()(std::array<uint64_t, Lanes> halves,
+                                                             const des::RoundKeys &round_keys) const noexcept {
+            des::encrypt_lanes(halves, round_keys);
+            return halves;
+        }
     };
 
 
     class DEALCipher : public FeistelNetwork {
+        std::array<des::RoundKeys, 8> _schedules{};
+
     public:
         DEALCipher() : FeistelNetwork(std::make_unique<DEALKeyExpansion>(),
                                       std::make_unique<DESAdapter>()) {}
 
         void set_round_keys(std::span<const uint8_t> encryption_key) override;
 
+        std::vector<uint8_t> encrypt(std::span<const uint8_t> block) const override;
+
+        std::vector<uint8_t> decrypt(std::span<const uint8_t> block) const override;
+
         [[nodiscard]] size_t get_block_size() const override;
+
+        void encrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const override;
+
+        void decrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const override;
+
+    private:
+        // Число одновременно обрабатываемых блоков в пакетном режиме
+        static constexpr size_t _interleave_lanes = 4;
+
+        std::vector<uint8_t> process(std::span<const uint8_t> block, bool encrypt) const;
+
+        void process_blocks(std::span<const uint8_t> input, std::span<uint8_t> output, bool encrypt) const;
     };
 }
 
@@ -1,10 +1,63 @@
 #ifndef DES_H
 #define DES_H
 
+#include <algorithm>
+#include <array>
+#include <stdexcept>
 #include "feistel_network.h"
 #include "interfaces.h"
+#include "bit_operations.h"
+#include "des_key_schedule.h"
 
 namespace crypto::des {
+    /**
+     * Раундовая функция DES над 32-битной половиной блока: P(S(E(R) ^ K))
+     */
+    struct DESRoundFunction {
+        [[nodiscard]] uint32_t operator()(uint32_t half, uint64_t round_key) const noexcept;
+    };
+
+    /**
+     * Шифрование/расшифрование 64-битного блока без аллокаций
+     */
+    [[nodiscard]] uint64_t encrypt_block(uint64_t block, const RoundKeys &round_keys) noexcept;
+
+    [[nodiscard]] uint64_t decrypt_block(uint64_t block, const RoundKeys &round_keys) noexcept;
+
+    // Число одновременно обрабатываемых блоков в пакетном режиме
+    constexpr size_t INTERLEAVE_LANES = 8;
+
+    /**
+     * Шифрование Lanes независимых блоков с чередованием раундов (инстанцировано для 4 и 8)
+     */
+    template<size_t Lanes>
+    void encrypt_lanes(std::array<uint64_t, Lanes> &blocks, const RoundKeys &round_keys) noexcept;
+
+    template<size_t Lanes>
+    void decrypt_lanes(std::array<uint64_t, Lanes> &blocks, const RoundKeys &round_keys) noexcept;
+
+    /**
+     * Обход подряд идущих 64-битных блоков группами по Lanes, неполная последняя группа дополняется нулями.
+     * input и output могут совпадать
+     */
+    template<size_t Lanes, typename LanesFunction>
+    void for_each_lanes(std::span<const uint8_t> input, std::span<uint8_t> output, LanesFunction &&function) {
+        if (input.size() % 8 != 0 || output.size() != input.size())
+            throw std::invalid_argument("data length must be multiple of block size");
+
+        for (size_t offset = 0; offset < input.size(); offset += Lanes * 8) {
+            const size_t count = std::min(Lanes, (input.size() - offset) / 8);
+            std::array<uint64_t, Lanes> blocks{};
+            for (size_t lane = 0; lane < count; ++lane) {
+                blocks[lane] = bits::load_be<uint64_t>(input.subspan(offset + lane * 8, 8));
+            }
+            function(blocks);
+            for (size_t lane = 0; lane < count; ++lane) {
+                bits::store_be(blocks[lane], output.subspan(offset + lane * 8, 8));
+            }
+        }
+    }
+
     class DESKeyExpansion final : public IKeyExpansion {
     public:
         std::vector<std::vector<uint8_t> > generate_round_keys(std::span<const uint8_t> input_key) override;
@@ -17,16 +70,31 @@ namespace crypto::des {
     };
 
     class DESCipher : public FeistelNetwork {
+        RoundKeys _schedule{};
+
     public:
         DESCipher() : FeistelNetwork(std::make_unique<DESKeyExpansion>(),
                                      std::make_unique<DESEncryptionTransform>(),
                                      16) {}
 
+        void set_round_keys(std::span<const uint8_t> encryption_key) override;
+
         std::vector<uint8_t> encrypt(std::span<const uint8_t> block) const override;
 
         std::vector<uint8_t> decrypt(std::span<const uint8_t> block) const override;
 
         [[nodiscard]] size_t get_block_size() const override;
+
+        void encrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const override;
+
+        void decrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const override;
+
+        // Блочные операции без проверок: ключи должны быть установлены
+        [[nodiscard]] uint64_t encrypt_block(uint64_t block) const noexcept { return des::encrypt_block(block, _schedule); }
+
+        [[nodiscard]] uint64_t decrypt_block(uint64_t block) const noexcept { return des::decrypt_block(block, _schedule); }
+
+        [[nodiscard]] const RoundKeys &get_schedule() const noexcept { return _schedule; }
     };
 }
 
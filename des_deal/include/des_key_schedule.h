@@ -0,0 +1,58 @@
+#ifndef DES_KEY_SCHEDULE_H
+#define DES_KEY_SCHEDULE_H
+
+#include <array>
+#include <cstdint>
+#include "bit_operations.h"
+
+namespace crypto::des {
+    // 16 раундовых ключей по 48 бит, выровненных по младшему краю
+    using RoundKeys = std::array<uint64_t, 16>;
+
+    namespace detail {
+        inline constexpr uint16_t PC1[] = {
+            57, 49, 41, 33, 25, 17, 9,
+            1, 58, 50, 42, 34, 26, 18,
+            10, 2, 59, 51, 43, 35, 27,
+            19, 11, 3, 60, 52, 44, 36,
+            63, 55, 47, 39, 31, 23, 15,
+            7, 62, 54, 46, 38, 30, 22,
+            14, 6, 61, 53, 45, 37, 29,
+            21, 13, 5, 28, 20, 12, 4
+        };
+
+        inline constexpr uint16_t PC2[] = {
+            14, 17, 11, 24, 1, 5,
+            3, 28, 15, 6, 21, 10,
+            23, 19, 12, 4, 26, 8,
+            16, 7, 27, 20, 13, 2,
+            41, 52, 31, 37, 47, 55,
+            30, 40, 51, 45, 33, 48,
+            44, 49, 39, 56, 34, 53,
+            46, 42, 50, 36, 29, 32
+        };
+
+        inline constexpr uint8_t SHIFTS[] = {1, 1, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 1};
+
+        inline constexpr auto PC1_TABLE = bits::make_permutation_table<64>(PC1);
+        inline constexpr auto PC2_TABLE = bits::make_permutation_table<56>(PC2);
+    }
+
+    /**
+     * Ключевое расписание DES для 64-битного ключа (big-endian). Вычислимо на этапе компиляции
+     */
+    constexpr RoundKeys expand_key(uint64_t key) noexcept {
+        const uint64_t permuted = bits::permute_word<64>(key, detail::PC1_TABLE);
+        auto left = static_cast<uint32_t>(permuted >> 28);
+        auto right = static_cast<uint32_t>(permuted & ((1 << 28) - 1));
+        RoundKeys round_keys{};
+        for (size_t i = 0; i < round_keys.size(); ++i) {
+            bits::shift_left(left, detail::SHIFTS[i]);
+            bits::shift_left(right, detail::SHIFTS[i]);
+            round_keys[i] = bits::permute_word<56>((static_cast<uint64_t>(left) << 28) | right, detail::PC2_TABLE);
+        }
+        return round_keys;
+    }
+}
+
+#endif //DES_KEY_SCHEDULE_H
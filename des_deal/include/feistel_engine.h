@@ -0,0 +1,104 @@
+#ifndef FEISTEL_ENGINE_H
+#define FEISTEL_ENGINE_H
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <ranges>
+#include <utility>
+
+namespace crypto {
+    namespace feistel {
+        /**
+         * left ^= right для целых половин блока и для байтовых контейнеров (std::array, std::vector)
+         */
+        template<typename HalfBlock>
+        constexpr void xor_halves(HalfBlock &left, const HalfBlock &right) noexcept {
+            if constexpr (requires { left ^= right; }) {
+                left ^= right;
+            }
+            else {
+                for (size_t i = 0; i < std::size(left); ++i) {
+                    left[i] ^= right[i];
+                }
+            }
+        }
+    }
+
+    /**
+     * Сеть Фейстеля без виртуальных вызовов и аллокаций.
+     * HalfBlock - тип половины блока, RoundFunction - функтор F(half, round_key) -> HalfBlock.
+     * Раунд: (L, R) -> (R, L ^ F(R, K_i)), после последнего раунда половины меняются местами,
+     * поэтому результат - left || right.
+     */
+    template<typename HalfBlock, typename RoundFunction>
+    class FeistelEngine {
+        [[no_unique_address]] RoundFunction _round_function{};
+
+    public:
+        constexpr FeistelEngine() = default;
+
+        constexpr explicit FeistelEngine(RoundFunction round_function) : _round_function(std::move(round_function)) {}
+
+        template<std::ranges::input_range RoundKeys>
+        constexpr void encrypt(HalfBlock &left, HalfBlock &right, const RoundKeys &round_keys) const {
+            run(left, right, round_keys);
+        }
+
+        template<std::ranges::bidirectional_range RoundKeys>
+        constexpr void decrypt(HalfBlock &left, HalfBlock &right, const RoundKeys &round_keys) const {
+            run(left, right, round_keys | std::views::reverse);
+        }
+
+        /**
+         * Чередование Lanes независимых блоков: раунд применяется ко всем блокам подряд, поэтому
+         * цепочки зависимостей разных блоков перекрываются в конвейере процессора.
+         * Если RoundFunction умеет обрабатывать массив половин целиком, он вызывается один раз на раунд
+         */
+        template<size_t Lanes, std::ranges::input_range RoundKeys>
+        constexpr void encrypt_lanes(std::array<HalfBlock, Lanes> &left, std::array<HalfBlock, Lanes> &right,
+                                     const RoundKeys &round_keys) const {
+            run_lanes(left, right, round_keys);
+        }
+
+        template<size_t Lanes, std::ranges::bidirectional_range RoundKeys>
+        constexpr void decrypt_lanes(std::array<HalfBlock, Lanes> &left, std::array<HalfBlock, Lanes> &right,
+                                     const RoundKeys &round_keys) const {
+            run_lanes(left, right, round_keys | std::views::reverse);
+        }
+
+    private:
+        template<size_t Lanes, typename RoundKeys>
+        constexpr void run_lanes(std::array<HalfBlock, Lanes> &left, std::array<HalfBlock, Lanes> &right,
+                                 RoundKeys &&round_keys) const {
+            for (const auto &round_key: round_keys) {
+                if constexpr (requires {
+                    { _round_function(right, round_key) } -> std::convertible_to<std::array<HalfBlock, Lanes> >;
+                }) {
+                    const std::array<HalfBlock, Lanes> f_result = _round_function(right, round_key);
+                    for (size_t lane = 0; lane < Lanes; ++lane) {
+                        feistel::xor_halves(left[lane], f_result[lane]);
+                    }
+                }
+                else {
+                    for (size_t lane = 0; lane < Lanes; ++lane) {
+                        feistel::xor_halves(left[lane], _round_function(right[lane], round_key));
+                    }
+                }
+                std::swap(left, right);
+            }
+            std::swap(left, right);
+        }
+
+        template<typename RoundKeys>
+        constexpr void run(HalfBlock &left, HalfBlock &right, RoundKeys &&round_keys) const {
+            for (const auto &round_key: round_keys) {
+                feistel::xor_halves(left, _round_function(right, round_key));
+                std::swap(left, right);
+            }
+            std::swap(left, right);
+        }
+    };
+}
+
+#endif //FEISTEL_ENGINE_H
@@ -41,6 +41,10 @@ namespace crypto {
         // Геттеры для тестирования
         const std::vector<std::vector<uint8_t> > &get_round_keys() const { return _round_keys; }
         size_t get_rounds_count() const { return _round_keys.size(); }
+
+    private:
+        // Обобщённый путь через виртуальную раундовую функцию (FeistelEngine над std::vector)
+        std::vector<uint8_t> process(std::span<const uint8_t> block, bool encrypt) const;
     };
 }
 
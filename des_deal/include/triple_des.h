@@ -19,6 +19,10 @@ namespace crypto::triple_des {
         void set_round_keys(std::span<const uint8_t> encryption_key) override;
 
         size_t get_block_size() const override;
+
+        void encrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const override;
+
+        void decrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const override;
     };
 }
 
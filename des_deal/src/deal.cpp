@@ -1,6 +1,8 @@
 #include "deal.h"
+#include "bit_operations.h"
 
-static const uint8_t expansion_key[] = {0x12, 0x34, 0x56, 0x78, 0x90, 0xAB, 0xCD, 0xEF};
+// Расписание DES для фиксированного ключа расширения 0x1234567890ABCDEF вычисляется на этапе компиляции
+static constexpr crypto::des::RoundKeys expansion_schedule = crypto::des::expand_key(0x1234567890ABCDEF);
 
 std::vector<uint8_t> crypto::deal::DESAdapter::transform(std::span<const uint8_t> input_block,
                                                          std::span<const uint8_t> round_key) const {
@@ -18,51 +20,108 @@ std::vector<uint8_t> crypto::deal::DESAdapter::transform(std::span<const uint8_t
     return des_it->second.encrypt(input_block);
 }
 
-std::vector<std::vector<uint8_t> > crypto::deal::DEALKeyExpansion::generate_round_keys(
-    std::span<const uint8_t> input_key) {
+size_t crypto::deal::DEALKeyExpansion::expand(std::span<const uint8_t> input_key, std::array<uint64_t, 8> &round_keys) {
     if (input_key.size() != 16 && input_key.size() != 24 && input_key.size() != 32)
         throw std::invalid_argument("invalid key size");
 
-    size_t rounds = input_key.size() == 16 ? 6 : 8;
-    des::DESCipher des;
-    des.set_round_keys(expansion_key);
-    std::vector<std::vector<uint8_t> > res;
-    res.reserve(rounds);
-    std::vector<uint8_t> prev(8, 0);
-    if (input_key.size() == 16) {
-        for (size_t i = 0; i < rounds; ++i) {
-            for (size_t j = 0; j < 8; ++j) {
-                prev[j] ^= input_key[(i * 8 + j) % input_key.size()];
-            }
-            prev = des.encrypt(prev);
-            res.push_back(prev);
-        }
-    }
-    else if (input_key.size() == 24) {
-        for (size_t i = 0; i < rounds; ++i) {
-            for (size_t j = 0; j < 8; ++j) {
-                prev[j] ^= input_key[(i * 8 + j) % ((i < rounds - 1) ? 16 : 24)];
-            }
-            prev = des.encrypt(prev);
-            res.push_back(prev);
+    const size_t rounds = input_key.size() == 16 ? 6 : 8;
+    uint64_t prev = 0;
+    for (size_t i = 0; i < rounds; ++i) {
+        // для 192-битного ключа последние 8 байт участвуют только в последнем раунде
+        const size_t key_size = input_key.size() == 24 && i < rounds - 1 ? 16 : input_key.size();
+        uint64_t key_part = 0;
+        for (size_t j = 0; j < 8; ++j) {
+            key_part = (key_part << 8) | input_key[(i * 8 + j) % key_size];
         }
+        prev = des::encrypt_block(prev ^ key_part, expansion_schedule);
+        round_keys[i] = prev;
     }
-    else {
-        for (size_t i = 0; i < rounds; ++i) {
-            for (size_t j = 0; j < 8; ++j) {
-                prev[j] ^= input_key[(i * 8 + j) % input_key.size()];
-            }
-            prev = des.encrypt(prev);
-            res.push_back(prev);
-        }
+    return rounds;
+}
+
+std::vector<std::vector<uint8_t> > crypto::deal::DEALKeyExpansion::generate_round_keys(
+    std::span<const uint8_t> input_key) {
+    std::array<uint64_t, 8> round_keys{};
+    const size_t rounds = expand(input_key, round_keys);
+    std::vector<std::vector<uint8_t> > res(rounds, std::vector<uint8_t>(8));
+    for (size_t i = 0; i < rounds; ++i) {
+        bits::store_be(round_keys[i], res[i]);
     }
     return res;
 }
 
 void crypto::deal::DEALCipher::set_round_keys(std::span<const uint8_t> encryption_key) {
-    set_rounds_count(encryption_key.size() == 16 ? 6 : 8);
+    std::array<uint64_t, 8> round_keys{};
+    const size_t rounds = DEALKeyExpansion::expand(encryption_key, round_keys);
+    set_rounds_count(rounds);
     static_cast<DESAdapter *>(_round_function.get())->_des_cyphers.clear();
-    FeistelNetwork::set_round_keys(encryption_key);
+    // Байтовые раундовые ключи для геттеров и обобщённого пути; при повторной установке память переиспользуется
+    _round_keys.resize(rounds);
+    for (size_t i = 0; i < rounds; ++i) {
+        _round_keys[i].resize(8);
+        bits::store_be(round_keys[i], _round_keys[i]);
+        _schedules[i] = des::expand_key(round_keys[i]);
+    }
+}
+
+std::vector<uint8_t> crypto::deal::DEALCipher::encrypt(std::span<const uint8_t> block) const {
+    return process(block, true);
+}
+
+std::vector<uint8_t> crypto::deal::DEALCipher::decrypt(std::span<const uint8_t> block) const {
+    return process(block, false);
+}
+
+std::vector<uint8_t> crypto::deal::DEALCipher::process(std::span<const uint8_t> block, bool encrypt) const {
+    if (block.size() != 16)
+        throw std::invalid_argument("input block must be 16 bytes");
+    if (_round_keys.size() != _rounds)
+        throw std::runtime_error("Round keys not set");
+
+    auto left = bits::load_be<uint64_t>(block.first(8));
+    auto right = bits::load_be<uint64_t>(block.subspan(8));
+    const FeistelEngine<uint64_t, DEALRoundFunction> engine;
+    const auto round_keys = std::span(_schedules).first(_rounds);
+    if (encrypt) engine.encrypt(left, right, round_keys);
+    else engine.decrypt(left, right, round_keys);
+
+    std::vector<uint8_t> result(16);
+    bits::store_be(left, std::span(result).first(8));
+    bits::store_be(right, std::span(result).subspan(8));
+    return result;
 }
 
 size_t crypto::deal::DEALCipher::get_block_size() const { return 16; }
+
+void crypto::deal::DEALCipher::encrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const {
+    process_blocks(input, output, true);
+}
+
+void crypto::deal::DEALCipher::decrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const {
+    process_blocks(input, output, false);
+}
+
+void crypto::deal::DEALCipher::process_blocks(std::span<const uint8_t> input, std::span<uint8_t> output,
+                                              bool encrypt) const {
+    if (input.size() % 16 != 0 || output.size() != input.size())
+        throw std::invalid_argument("data length must be multiple of block size");
+    if (_round_keys.size() != _rounds)
+        throw std::runtime_error("Round keys not set");
+
+    const FeistelEngine<uint64_t, DEALRoundFunction> engine;
+    const auto round_keys = std::span(_schedules).first(_rounds);
+    for (size_t offset = 0; offset < input.size(); offset += _interleave_lanes * 16) {
+        const size_t count = std::min(_interleave_lanes, (input.size() - offset) / 16);
+        std::array<uint64_t, _interleave_lanes> left{}, right{};
+        for (size_t lane = 0; lane < count; ++lane) {
+            left[lane] = bits::load_be<uint64_t>(input.subspan(offset + lane * 16, 8));
+            right[lane] = bits::load_be<uint64_t>(input.subspan(offset + lane * 16 + 8, 8));
+        }
+        if (encrypt) engine.encrypt_lanes(left, right, round_keys);
+        else engine.decrypt_lanes(left, right, round_keys);
+        for (size_t lane = 0; lane < count; ++lane) {
+            bits::store_be(left[lane], output.subspan(offset + lane * 16, 8));
+            bits::store_be(right[lane], output.subspan(offset + lane * 16 + 8, 8));
+        }
+    }
+}
@@ -1,30 +1,9 @@
 #include "des.h"
+#include "feistel_engine.h"
 #include "bit_operations.h"
 
 namespace crypto::des {
-    const static uint16_t PC1[] = {
-        57, 49, 41, 33, 25, 17, 9,
-        1, 58, 50, 42, 34, 26, 18,
-        10, 2, 59, 51, 43, 35, 27,
-        19, 11, 3, 60, 52, 44, 36,
-        63, 55, 47, 39, 31, 23, 15,
-        7, 62, 54, 46, 38, 30, 22,
-        14, 6, 61, 53, 45, 37, 29,
-        21, 13, 5, 28, 20, 12, 4
-    };
-
-    const static uint16_t PC2[] = {
-        14, 17, 11, 24, 1, 5,
-        3, 28, 15, 6, 21, 10,
-        23, 19, 12, 4, 26, 8,
-        16, 7, 27, 20, 13, 2,
-        41, 52, 31, 37, 47, 55,
-        30, 40, 51, 45, 33, 48,
-        44, 49, 39, 56, 34, 53,
-        46, 42, 50, 36, 29, 32
-    };
-
-    const static uint16_t E[] = {
+    constexpr static uint16_t E[] = {
         32, 1, 2, 3, 4, 5,
         4, 5, 6, 7, 8, 9,
         8, 9, 10, 11, 12, 13,
@@ -35,9 +14,7 @@ namespace crypto::des {
         28, 29, 30, 31, 32, 1
     };
 
-    const static uint8_t SHIFTS[] = {1, 1, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 1};
-
-    const static uint8_t S[8][4][16] = {
+    constexpr static uint8_t S[8][4][16] = {
         {
             {14, 4, 13, 1, 2, 15, 11, 8, 3, 10, 6, 12, 5, 9, 0, 7},
             {0, 15, 7, 4, 14, 2, 13, 1, 10, 6, 12, 11, 9, 5, 3, 8},
@@ -88,14 +65,14 @@ namespace crypto::des {
         }
     };
 
-    const static uint16_t P[] = {
+    constexpr static uint16_t P[] = {
         16, 7, 20, 21, 29, 12, 28, 17,
         1, 15, 23, 26, 5, 18, 31, 10,
         2, 8, 24, 14, 32, 27, 3, 9,
         19, 13, 30, 6, 22, 11, 4, 25
     };
 
-    const static uint16_t IP[] = {
+    constexpr static uint16_t IP[] = {
         58, 50, 42, 34, 26, 18, 10, 2,
         60, 52, 44, 36, 28, 20, 12, 4,
         62, 54, 46, 38, 30, 22, 14, 6,
@@ -106,7 +83,7 @@ namespace crypto::des {
         63, 55, 47, 39, 31, 23, 15, 7
     };
 
-    const static uint16_t IP_INVERSE[] = {
+    constexpr static uint16_t IP_INVERSE[] = {
         40, 8, 48, 16, 56, 24, 64, 32,
         39, 7, 47, 15, 55, 23, 63, 31,
         38, 6, 46, 14, 54, 22, 62, 30,
@@ -117,36 +94,111 @@ namespace crypto::des {
         33, 1, 41, 9, 49, 17, 57, 25
     };
 
+    constexpr auto IP_TABLE = bits::make_permutation_table<64>(IP);
+    constexpr auto IP_INVERSE_TABLE = bits::make_permutation_table<64>(IP_INVERSE);
+    constexpr auto E_TABLE = bits::make_permutation_table<32>(E);
+
+    // S-блоки, совмещённые с перестановкой P: SP[i][6 бит] -> вклад i-го S-блока в 32-битный результат
+    constexpr auto SP = [] {
+        std::array<std::array<uint32_t, 64>, 8> sp{};
+        for (size_t i = 0; i < 8; ++i) {
+            for (uint8_t six_bits = 0; six_bits < 64; ++six_bits) {
+                const uint8_t row = ((six_bits & 0x20) >> 4) | (six_bits & 0x01);
+                const uint8_t col = (six_bits >> 1) & 0x0F;
+                const uint64_t s_value = static_cast<uint64_t>(S[i][row][col]) << (28 - 4 * i);
+                sp[i][six_bits] = static_cast<uint32_t>(bits::permute_word(s_value, 32, P));
+            }
+        }
+        return sp;
+    }();
+
+    uint32_t DESRoundFunction::operator()(uint32_t half, uint64_t round_key) const noexcept {
+        const uint64_t xored = bits::permute_word<32>(half, E_TABLE) ^ round_key;
+        uint32_t result = 0;
+        for (size_t i = 0; i < 8; ++i) {
+            result |= SP[i][(xored >> (42 - 6 * i)) & 0x3F];
+        }
+        return result;
+    }
+
+    template<bool Encrypt>
+    static uint64_t process_block(uint64_t block, const RoundKeys &round_keys) noexcept {
+        const uint64_t permuted = bits::permute_word<64>(block, IP_TABLE);
+        auto left = static_cast<uint32_t>(permuted >> 32);
+        auto right = static_cast<uint32_t>(permuted);
+        const FeistelEngine<uint32_t, DESRoundFunction> engine;
+        if constexpr (Encrypt) engine.encrypt(left, right, round_keys);
+        else engine.decrypt(left, right, round_keys);
+        return bits::permute_word<64>((static_cast<uint64_t>(left) << 32) | right, IP_INVERSE_TABLE);
+    }
+
+    uint64_t encrypt_block(uint64_t block, const RoundKeys &round_keys) noexcept {
+        return process_block<true>(block, round_keys);
+    }
+
+    uint64_t decrypt_block(uint64_t block, const RoundKeys &round_keys) noexcept {
+        return process_block<false>(block, round_keys);
+    }
+
+    template<bool Encrypt, size_t Lanes>
+    static void process_lanes(std::array<uint64_t, Lanes> &blocks, const RoundKeys &round_keys) noexcept {
+        std::array<uint32_t, Lanes> left, right;
+        for (size_t lane = 0; lane < Lanes; ++lane) {
+            const uint64_t permuted = bits::permute_word<64>(blocks[lane], IP_TABLE);
+            left[lane] = static_cast<uint32_t>(permuted >> 32);
+            right[lane] = static_cast<uint32_t>(permuted);
+        }
+        const FeistelEngine<uint32_t, DESRoundFunction> engine;
+        if constexpr (Encrypt) engine.encrypt_lanes(left, right, round_keys);
+        else engine.decrypt_lanes(left, right, round_keys);
+        for (size_t lane = 0; lane < Lanes; ++lane) {
+            blocks[lane] = bits::permute_word<64>((static_cast<uint64_t>(left[lane]) << 32) | right[lane],
+                                                  IP_INVERSE_TABLE);
+        }
+    }
+
+    template<size_t Lanes>
+    void encrypt_lanes(std::array<uint64_t, Lanes> &blocks, const RoundKeys &round_keys) noexcept {
+        process_lanes<true>(blocks, round_keys);
+    }
+
+    template<size_t Lanes>
+    void decrypt_lanes(std::array<uint64_t, Lanes> &blocks, const RoundKeys &round_keys) noexcept {
+        process_lanes<false>(blocks, round_keys);
+    }
+
+    template void encrypt_lanes<4>(std::array<uint64_t, 4> &, const RoundKeys &) noexcept;
+    template void encrypt_lanes<8>(std::array<uint64_t, 8> &, const RoundKeys &) noexcept;
+    template void decrypt_lanes<4>(std::array<uint64_t, 4> &, const RoundKeys &) noexcept;
+    template void decrypt_lanes<8>(std::array<uint64_t, 8> &, const RoundKeys &) noexcept;
+
+    static uint64_t load_round_key(std::span<const uint8_t> round_key) noexcept {
+        uint64_t key = 0;
+        for (auto byte: round_key) {
+            key = (key << 8) | byte;
+        }
+        return key;
+    }
+
+    static void store_round_key(uint64_t key, std::span<uint8_t> round_key) noexcept {
+        for (size_t i = round_key.size(); i-- > 0;) {
+            round_key[i] = static_cast<uint8_t>(key & 0xFF);
+            key >>= 8;
+        }
+    }
+
     std::vector<std::vector<uint8_t> > DESKeyExpansion::generate_round_keys(std::span<const uint8_t> input_key) {
         if (input_key.size() != 8) {
             throw std::invalid_argument("input key must be 8 bytes");
         }
-        std::vector<std::vector<uint8_t> > round_keys;
-        round_keys.reserve(16);
-        const auto permuted_vec = bits::permute_bits(input_key, PC1, bits::BitIndexing::MSB_FIRST, bits::StartBit::ONE);
-        uint64_t permuted = 0;
-        for (int i = 0; i < 7; i++) {
-            permuted <<= 8;
-            permuted |= permuted_vec[i];
-        }
-        uint32_t left = permuted >> 28;
-        uint32_t right = permuted & ((1 << 28) - 1);
-        for (int i = 0; i < 16; ++i) {
-            bits::shift_left(left, SHIFTS[i]);
-            bits::shift_left(right, SHIFTS[i]);
-            uint64_t joined = (static_cast<uint64_t>(left) << 28) | right;
-            std::vector<uint8_t> joined_vec(7, 0);
-            for (int j = 6; j >= 0; j--) {
-                joined_vec[j] = joined & 0xFF;
-                joined >>= 8;
-            }
-            round_keys.push_back(bits::permute_bits(joined_vec, PC2, bits::BitIndexing::MSB_FIRST,
-                                                    bits::StartBit::ONE));
+        const auto schedule = expand_key(bits::load_be<uint64_t>(input_key));
+        std::vector<std::vector<uint8_t> > round_keys(schedule.size(), std::vector<uint8_t>(6));
+        for (size_t i = 0; i < schedule.size(); ++i) {
+            store_round_key(schedule[i], round_keys[i]);
         }
         return round_keys;
     }
 
-
     std::vector<uint8_t> DESEncryptionTransform::transform(std::span<const uint8_t> input_block,
                                                            std::span<const uint8_t> round_key) const {
         if (input_block.size() != 4)
@@ -154,58 +206,64 @@ namespace crypto::des {
         if (round_key.size() != 6)
             throw std::invalid_argument("round_key must be 6 bytes");
 
-        const auto extended = bits::permute_bits(
-            input_block, E, bits::BitIndexing::MSB_FIRST, bits::StartBit::ONE);
-        std::vector<uint8_t> xor_bytes(extended.size());
-        for (auto i = 0; i < extended.size(); ++i) {
-            xor_bytes[i] = extended[i] ^ round_key[i];
-        }
-
-        std::vector<bool> bits;
-        for (uint8_t byte: xor_bytes) {
-            for (int i = 7; i >= 0; --i) {
-                bits.push_back((byte >> i) & 1u);
-            }
-        }
+        std::vector<uint8_t> result(4);
+        bits::store_be(DESRoundFunction{}(bits::load_be<uint32_t>(input_block), load_round_key(round_key)), result);
+        return result;
+    }
 
-        std::vector<uint8_t> s_box_bits;
-        for (auto i = 0; i < 8; ++i) {
-            uint8_t six_bits = 0;
-            for (int j = 0; j < 6; ++j) {
-                six_bits = (six_bits << 1) | (bits[i * 6 + j] ? 1u : 0u);
-            }
-            uint8_t row = ((six_bits & 0x20) >> 4) | (six_bits & 0x01);
-            uint8_t col = (six_bits >> 1) & 0x0F;
-            uint8_t s_value = S[i][row][col];
-            for (int j = 3; j >= 0; --j) {
-                s_box_bits.push_back((s_value >> j) & 1u);
-            }
+    void DESCipher::set_round_keys(std::span<const uint8_t> encryption_key) {
+        if (encryption_key.size() != 8) {
+            throw std::invalid_argument("input key must be 8 bytes");
         }
-        std::vector<uint8_t> s_box_output(4, 0);
-        for (size_t i = 0; i < s_box_bits.size(); ++i) {
-            if (s_box_bits[i]) {
-                s_box_output[i / 8] |= 1u << (7 - (i % 8));
-            }
+        _schedule = expand_key(bits::load_be<uint64_t>(encryption_key));
+        // Байтовые раундовые ключи для геттеров и обобщённого пути; при повторной установке память переиспользуется
+        _round_keys.resize(_schedule.size());
+        for (size_t i = 0; i < _schedule.size(); ++i) {
+            _round_keys[i].resize(6);
+            store_round_key(_schedule[i], _round_keys[i]);
         }
-        return bits::permute_bits(s_box_output, P, bits::BitIndexing::MSB_FIRST, bits::StartBit::ONE);
     }
 
     std::vector<uint8_t> DESCipher::encrypt(std::span<const uint8_t> block) const {
         if (block.size() != 8) {
             throw std::invalid_argument("input block must be 8 bytes");
         }
-        auto permuted = bits::permute_bits(block, IP, bits::BitIndexing::MSB_FIRST, bits::StartBit::ONE);
-        permuted = FeistelNetwork::encrypt(permuted);
-        return bits::permute_bits(permuted, IP_INVERSE, bits::BitIndexing::MSB_FIRST, bits::StartBit::ONE);
+        if (_round_keys.size() != _rounds) {
+            throw std::runtime_error("Round keys not set");
+        }
+        std::vector<uint8_t> result(8);
+        bits::store_be(encrypt_block(bits::load_be<uint64_t>(block)), result);
+        return result;
     }
 
     std::vector<uint8_t> DESCipher::decrypt(std::span<const uint8_t> block) const {
         if (block.size() != 8) {
             throw std::invalid_argument("input block must be 8 bytes");
         }
-        auto permuted = bits::permute_bits(block, IP, bits::BitIndexing::MSB_FIRST, bits::StartBit::ONE);
-        permuted = FeistelNetwork::decrypt(permuted);
-        return bits::permute_bits(permuted, IP_INVERSE, bits::BitIndexing::MSB_FIRST, bits::StartBit::ONE);
+        if (_round_keys.size() != _rounds) {
+            throw std::runtime_error("Round keys not set");
+        }
+        std::vector<uint8_t> result(8);
+        bits::store_be(decrypt_block(bits::load_be<uint64_t>(block)), result);
+        return result;
+    }
+
+    void DESCipher::encrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const {
+        if (_round_keys.size() != _rounds) {
+            throw std::runtime_error("Round keys not set");
+        }
+        for_each_lanes<INTERLEAVE_LANES>(input, output, [this](auto &blocks) {
+            encrypt_lanes(blocks, _schedule);
+        });
+    }
+
+    void DESCipher::decrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const {
+        if (_round_keys.size() != _rounds) {
+            throw std::runtime_error("Round keys not set");
+        }
+        for_each_lanes<INTERLEAVE_LANES>(input, output, [this](auto &blocks) {
+            decrypt_lanes(blocks, _schedule);
+        });
     }
 
     size_t DESCipher::get_block_size() const { return 8; }
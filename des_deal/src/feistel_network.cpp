@@ -1,7 +1,7 @@
 #include "feistel_network.h"
+#include "feistel_engine.h"
 #include <stdexcept>
 #include <algorithm>
-#include <future>
 
 namespace crypto {
     FeistelNetwork::FeistelNetwork(
@@ -40,38 +40,14 @@ namespace crypto {
     }
 
     std::vector<uint8_t> FeistelNetwork::encrypt(std::span<const uint8_t> block) const {
-        if (_round_keys.size() != _rounds) {
-            throw std::runtime_error("Round keys not set");
-        }
-        if (block.empty()) {
-            throw std::invalid_argument("Block cannot be empty");
-        }
-        if (block.size() % 2 != 0) {
-            throw std::invalid_argument("Block size must be even");
-        }
-        const size_t half_size = block.size() / 2;
-
-        std::vector left(block.begin(), block.begin() + half_size);
-        std::vector right(block.begin() + half_size, block.end());
-
-        for (size_t i = 0; i < _rounds; ++i) {
-            std::vector<uint8_t> f_result = _round_function->transform(right, _round_keys[i]);
-            std::vector<uint8_t> new_left = std::move(right);
-            std::vector<uint8_t> new_right(left.size());
-            for (size_t j = 0; j < left.size(); ++j) {
-                new_right[j] = left[j] ^ f_result[j];
-            }
-            left = std::move(new_left);
-            right = std::move(new_right);
-        }
-        std::vector<uint8_t> result(block.size());
-        std::ranges::copy(right, result.begin());
-        std::ranges::copy(left, result.begin() + half_size);
-
-        return result;
+        return process(block, true);
     }
 
     std::vector<uint8_t> FeistelNetwork::decrypt(std::span<const uint8_t> block) const {
+        return process(block, false);
+    }
+
+    std::vector<uint8_t> FeistelNetwork::process(std::span<const uint8_t> block, bool encrypt) const {
         if (_round_keys.size() != _rounds) {
             throw std::runtime_error("Round keys not set");
         }
@@ -81,27 +57,19 @@ namespace crypto {
         if (block.size() % 2 != 0) {
             throw std::invalid_argument("Block size must be even");
         }
-
         const size_t half_size = block.size() / 2;
+
         std::vector left(block.begin(), block.begin() + half_size);
         std::vector right(block.begin() + half_size, block.end());
 
-        for (size_t i = 0; i < _rounds; ++i) {
-            std::vector<uint8_t> new_left = right;
-            std::vector<uint8_t> f_result = _round_function->transform(right, _round_keys[_rounds - 1 - i]);
-            std::vector<uint8_t> new_right(left.size());
-            for (size_t j = 0; j < left.size(); ++j) {
-                new_right[j] = left[j] ^ f_result[j];
-            }
-
-            left = std::move(new_left);
-            right = std::move(new_right);
-        }
-
-        std::vector<uint8_t> result(block.size());
-        std::ranges::copy(right, result.begin());
-        std::ranges::copy(left, result.begin() + half_size);
+        auto round_function = [this](const std::vector<uint8_t> &half, const std::vector<uint8_t> &round_key) {
+            return _round_function->transform(half, round_key);
+        };
+        const FeistelEngine<std::vector<uint8_t>, decltype(round_function)> engine(round_function);
+        if (encrypt) engine.encrypt(left, right, _round_keys);
+        else engine.decrypt(left, right, _round_keys);
 
-        return result;
+        left.insert(left.end(), right.begin(), right.end());
+        return left;
     }
 }
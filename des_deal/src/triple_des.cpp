@@ -1,15 +1,28 @@
 #include "triple_des.h"
+#include "bit_operations.h"
 
 std::vector<uint8_t> crypto::triple_des::TripleDESCipher::encrypt(std::span<const uint8_t> block) const {
-    auto res = _des_cyphers[0].encrypt(block);
-    res = _des_cyphers[1].decrypt(res);
-    return _des_cyphers[2].encrypt(res);
+    if (block.size() != 8)
+        throw std::invalid_argument("input block must be 8 bytes");
+    if (_des_cyphers[0].get_rounds_count() == 0)
+        throw std::runtime_error("Round keys not set");
+    auto res = _des_cyphers[0].encrypt_block(bits::load_be<uint64_t>(block));
+    res = _des_cyphers[1].decrypt_block(res);
+    std::vector<uint8_t> result(8);
+    bits::store_be(_des_cyphers[2].encrypt_block(res), result);
+    return result;
 }
 
 std::vector<uint8_t> crypto::triple_des::TripleDESCipher::decrypt(std::span<const uint8_t> block) const {
-    auto res = _des_cyphers[2].decrypt(block);
-    res = _des_cyphers[1].encrypt(res);
-    return _des_cyphers[0].decrypt(res);
+    if (block.size() != 8)
+        throw std::invalid_argument("input block must be 8 bytes");
+    if (_des_cyphers[0].get_rounds_count() == 0)
+        throw std::runtime_error("Round keys not set");
+    auto res = _des_cyphers[2].decrypt_block(bits::load_be<uint64_t>(block));
+    res = _des_cyphers[1].encrypt_block(res);
+    std::vector<uint8_t> result(8);
+    bits::store_be(_des_cyphers[0].decrypt_block(res), result);
+    return result;
 }
 
 void crypto::triple_des::TripleDESCipher::set_round_keys(std::span<const uint8_t> encryption_key) {
@@ -23,3 +36,25 @@ void crypto::triple_des::TripleDESCipher::set_round_keys(std::span<const uint8_t
 }
 
 size_t crypto::triple_des::TripleDESCipher::get_block_size() const { return 8; }
+
+void crypto::triple_des::TripleDESCipher::encrypt_blocks(std::span<const uint8_t> input,
+                                                         std::span<uint8_t> output) const {
+    if (_des_cyphers[0].get_rounds_count() == 0)
+        throw std::runtime_error("Round keys not set");
+    des::for_each_lanes<des::INTERLEAVE_LANES>(input, output, [this](auto &blocks) {
+        des::encrypt_lanes(blocks, _des_cyphers[0].get_schedule());
+        des::decrypt_lanes(blocks, _des_cyphers[1].get_schedule());
+        des::encrypt_lanes(blocks, _des_cyphers[2].get_schedule());
+    });
+}
+
+void crypto::triple_des::TripleDESCipher::decrypt_blocks(std::span<const uint8_t> input,
+                                                         std::span<uint8_t> output) const {
+    if (_des_cyphers[0].get_rounds_count() == 0)
+        throw std::runtime_error("Round keys not set");
+    des::for_each_lanes<des::INTERLEAVE_LANES>(input, output, [this](auto &blocks) {
+        des::decrypt_lanes(blocks, _des_cyphers[2].get_schedule());
+        des::encrypt_lanes(blocks, _des_cyphers[1].get_schedule());
+        des::decrypt_lanes(blocks, _des_cyphers[0].get_schedule());
+    });
+}
@@ -4,6 +4,7 @@
 #include <random>
 #include <fstream>
 #include <filesystem>
+#include <chrono>
 
 namespace crypto::test {
     class CryptoTest : public ::testing::Test {
@@ -309,6 +310,61 @@ namespace crypto::test {
 
         EXPECT_THROW(context.encrypt_async(empty_data).get(), std::invalid_argument);
     }
+
+    // Регрессия: шифртекст одного блока не меняется между реализациями
+    TEST_F(CryptoTest, DEAL_128_KnownAnswerBlock) {
+        deal::DEALCipher deal;
+        deal.set_round_keys(test_key_128);
+
+        const std::vector<uint8_t> expected{
+            0x68, 0x41, 0x3E, 0x31, 0x06, 0x33, 0xBC, 0x5A,
+            0xB0, 0x23, 0x0C, 0xF1, 0x21, 0xC5, 0x6C, 0x4D
+        };
+        EXPECT_EQ(expected, deal.encrypt(test_iv));
+        EXPECT_EQ(test_iv, deal.decrypt(expected));
+    }
+
+    // Время смены ключа DEAL и DES (расписание ключа расширения DEAL вычислено при компиляции)
+    TEST_F(CryptoTest, RekeyBenchmark) {
+        constexpr size_t iterations = 10000;
+        deal::DEALCipher deal;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            deal.set_round_keys(test_key_256);
+        }
+        const std::chrono::duration<double, std::nano> deal_time = std::chrono::steady_clock::now() - start;
+
+        des::DESCipher des;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            des.set_round_keys(std::span(test_key_128).first(8));
+        }
+        const std::chrono::duration<double, std::nano> des_time = std::chrono::steady_clock::now() - start;
+
+        EXPECT_EQ(8, deal.get_rounds_count());
+        std::cout << "DEAL-256 rekey: " << deal_time.count() / iterations << " ns, DES rekey: "
+                << des_time.count() / iterations << " ns" << std::endl;
+    }
+
+    // Пакетная обработка с чередованием блоков совпадает с поблочной, включая неполную группу
+    TEST_F(CryptoTest, DEAL_256_InterleavedBlocksMatchSingleBlocks) {
+        deal::DEALCipher deal;
+        deal.set_round_keys(test_key_256);
+
+        auto data = generateRandomData(7 * 16);
+        std::vector<uint8_t> expected;
+        for (size_t offset = 0; offset < data.size(); offset += 16) {
+            auto encrypted = deal.encrypt(std::span(data).subspan(offset, 16));
+            expected.insert(expected.end(), encrypted.begin(), encrypted.end());
+        }
+        std::vector<uint8_t> encrypted(data.size());
+        deal.encrypt_blocks(data, encrypted);
+        EXPECT_EQ(expected, encrypted);
+
+        std::vector<uint8_t> decrypted(data.size());
+        deal.decrypt_blocks(encrypted, decrypted);
+        EXPECT_EQ(data, decrypted);
+    }
 }
 
 int main(int argc, char **argv) {
@@ -1,9 +1,12 @@
 #include <gtest/gtest.h>
 #include "context.h"
 #include "des.h"
+#include "feistel_engine.h"
+#include "bit_operations.h"
 #include <random>
 #include <fstream>
 #include <filesystem>
+#include <chrono>
 
 namespace crypto::test {
     class CryptoTest : public ::testing::Test {
@@ -209,6 +212,107 @@ namespace crypto::test {
 
         EXPECT_THROW(context.encrypt_async(empty_data).get(), std::invalid_argument);
     }
+
+    // Регрессия: шифртекст одного блока не меняется между реализациями
+    TEST_F(CryptoTest, KnownAnswerBlock) {
+        des::DESCipher des;
+        des.set_round_keys(test_key);
+
+        const std::vector<uint8_t> expected{0xD9, 0x54, 0x04, 0x9A, 0x41, 0x29, 0x93, 0x9E};
+        EXPECT_EQ(expected, des.encrypt(test_iv));
+        EXPECT_EQ(test_iv, des.decrypt(expected));
+    }
+
+    // Шаблонная сеть Фейстеля с половинами-массивами совпадает с целочисленной
+    TEST_F(CryptoTest, FeistelEngineByteArrayHalves) {
+        des::DESCipher des;
+        des.set_round_keys(test_key);
+
+        using Half = std::array<uint8_t, 4>;
+        auto round_function = [](const Half &half, uint64_t round_key) {
+            Half result{};
+            bits::store_be(des::DESRoundFunction{}(bits::load_be<uint32_t>(half), round_key), result);
+            return result;
+        };
+        const FeistelEngine<Half, decltype(round_function)> array_engine(round_function);
+        const FeistelEngine<uint32_t, des::DESRoundFunction> word_engine;
+
+        Half left{0x01, 0x23, 0x45, 0x67}, right{0x89, 0xAB, 0xCD, 0xEF};
+        uint32_t word_left = 0x01234567, word_right = 0x89ABCDEF;
+        array_engine.encrypt(left, right, des.get_schedule());
+        word_engine.encrypt(word_left, word_right, des.get_schedule());
+        EXPECT_EQ(word_left, bits::load_be<uint32_t>(left));
+        EXPECT_EQ(word_right, bits::load_be<uint32_t>(right));
+
+        array_engine.decrypt(left, right, des.get_schedule());
+        EXPECT_EQ((Half{0x01, 0x23, 0x45, 0x67}), left);
+        EXPECT_EQ((Half{0x89, 0xAB, 0xCD, 0xEF}), right);
+    }
+
+    // Ключевое расписание вычислимо на этапе компиляции и совпадает с байтовыми раундовыми ключами
+    TEST_F(CryptoTest, ConstexprKeySchedule) {
+        constexpr auto schedule = des::expand_key(0x133457799BBCDFF1);
+        static_assert(schedule[0] != schedule[1]);
+
+        des::DESCipher des;
+        des.set_round_keys(test_key);
+        EXPECT_EQ(schedule, des.get_schedule());
+
+        des::DESKeyExpansion expansion;
+        const auto round_keys = expansion.generate_round_keys(test_key);
+        ASSERT_EQ(schedule.size(), round_keys.size());
+        for (size_t i = 0; i < schedule.size(); ++i) {
+            EXPECT_EQ(round_keys[i], des.get_round_keys()[i]);
+            uint64_t key = 0;
+            for (auto byte: round_keys[i]) key = (key << 8) | byte;
+            EXPECT_EQ(schedule[i], key);
+        }
+    }
+
+    // Пакетная обработка с чередованием блоков совпадает с поблочной, включая неполную группу
+    TEST_F(CryptoTest, InterleavedBlocksMatchSingleBlocks) {
+        des::DESCipher des;
+        des.set_round_keys(test_key);
+
+        auto data = generateRandomData(13 * 8);
+        std::vector<uint8_t> expected;
+        for (size_t offset = 0; offset < data.size(); offset += 8) {
+            auto encrypted = des.encrypt(std::span(data).subspan(offset, 8));
+            expected.insert(expected.end(), encrypted.begin(), encrypted.end());
+        }
+        std::vector<uint8_t> encrypted(data.size());
+        des.encrypt_blocks(data, encrypted);
+        EXPECT_EQ(expected, encrypted);
+
+        std::vector<uint8_t> decrypted(data.size());
+        des.decrypt_blocks(encrypted, decrypted);
+        EXPECT_EQ(data, decrypted);
+    }
+
+    // Пропускная способность: один поток блоков против чередования по INTERLEAVE_LANES блоков
+    TEST_F(CryptoTest, InterleavedThroughputBenchmark) {
+        des::DESCipher des;
+        des.set_round_keys(test_key);
+
+        auto data = generateRandomData(1 << 22);
+        std::vector<uint8_t> single(data.size()), interleaved(data.size());
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset < data.size(); offset += 8) {
+            const auto block = bits::load_be<uint64_t>(std::span(data).subspan(offset, 8));
+            bits::store_be(des.encrypt_block(block), std::span(single).subspan(offset, 8));
+        }
+        const std::chrono::duration<double> single_time = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        des.encrypt_blocks(data, interleaved);
+        const std::chrono::duration<double> interleaved_time = std::chrono::steady_clock::now() - start;
+
+        EXPECT_EQ(single, interleaved);
+        const double megabytes = static_cast<double>(data.size()) / (1 << 20);
+        std::cout << "DES single-stream: " << megabytes / single_time.count() << " MB/s, interleaved x"
+                << des::INTERLEAVE_LANES << ": " << megabytes / interleaved_time.count() << " MB/s" << std::endl;
+    }
 }
 
 int main(int argc, char **argv) {
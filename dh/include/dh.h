@@ -26,6 +26,7 @@ namespace crypto {
         big_int _public_key;
         big_int _shared_secret;
         size_t _private_min_bit_len{};
+        bool _full_validation{false};
         std::random_device _rd{};
 
     public:
@@ -37,8 +38,12 @@ namespace crypto {
 
         void generate_private_key();
 
+        // p = 2q + 1 безопасное, поэтому ключ лежит в подгруппе порядка q тогда и только тогда, когда (key / p) = 1
         [[nodiscard]] bool validate_public_key(const big_int &key) const;
 
+        // Проверка ключа полным возведением key^q mod p вместо символа Лежандра
+        void set_full_validation(bool enabled) noexcept { _full_validation = enabled; }
+
         const big_int &get_shared_secret() const;
 
         const big_int &get_public_key() const;
@@ -47,7 +52,8 @@ namespace crypto {
 
         const big_int &get_prime_mod() const;
 
-        static std::pair<big_int, big_int> generate_prime_and_g(size_t bit_size);
+        // Безопасное простое p = 2q + 1 и генератор подгруппы порядка q, threads_count = 0 - по числу ядер
+        static std::pair<big_int, big_int> generate_prime_and_g(size_t bit_size, size_t threads_count = 0);
 
     private:
         constexpr void set_group_params(Group group) {
@@ -1,13 +1,30 @@
 #include "dh.h"
 #include "primary_tests.h"
+#include "prime_search.h"
 
+#include <array>
+#include <mutex>
+#include <optional>
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int_distribution.hpp>
 
+namespace {
+    // Таблица комба для g^x mod p стандартной группы: строится при первом DH этой группы и дальше только читается
+    const crypto::math::FixedBasePow &group_pow(crypto::DH::Group group, const crypto::big_int &g,
+                                                const crypto::big_int &p, size_t exp_bits) {
+        constexpr size_t groups_count = static_cast<size_t>(crypto::DH::Group::ffdhe8192) + 1;
+        static std::array<std::once_flag, groups_count> flags;
+        static std::array<std::optional<crypto::math::FixedBasePow>, groups_count> contexts;
+        const auto index = static_cast<size_t>(group);
+        std::call_once(flags[index], [&] { contexts[index].emplace(g, p, exp_bits); });
+        return *contexts[index];
+    }
+}
+
 crypto::DH::DH(Group group) {
     set_group_params(group);
     generate_private_key();
-    _public_key = mp::powm(_g, _private_key, _p);
+    _public_key = group_pow(group, _g, _p, _private_min_bit_len + 1).pow(_private_key);
 }
 
 crypto::DH::DH(big_int g, big_int p) {
@@ -16,24 +33,24 @@ crypto::DH::DH(big_int g, big_int p) {
     auto bits = mp::msb(p) + 1;
     if (bits < 512)
         throw std::invalid_argument("p is small");
-    primary::MillerRabinTest test;
+    primary::BailliePSWTest test;
     if (!test.is_primary(p, 0.999))
         throw std::invalid_argument("p is not prime");
     _q = (p - 1) / 2;
     if (!test.is_primary(_q, 0.999))
         throw std::invalid_argument("p is not safe prime");
-    if (mp::powm(g, _q, p) != 1)
+    if (math::mod_pow(g, _q, p) != 1)
         throw std::invalid_argument("g is bad");
     _p = std::move(p);
     _g = std::move(g);
     _private_min_bit_len = std::max(bits / 8, 225ul);
     generate_private_key();
-    _public_key = mp::powm(_g, _private_key, _p);
+    _public_key = math::mod_pow_sec(_g, _private_key, _p);
 }
 
 bool crypto::DH::compute_shared_secret(const big_int &other_pub) {
     if (!validate_public_key(other_pub)) return false;
-    _shared_secret = powm(other_pub, _private_key, _p);
+    _shared_secret = math::mod_pow_sec(other_pub, _private_key, _p);
     return true;
 }
 
@@ -46,7 +63,8 @@ void crypto::DH::generate_private_key() {
 
 bool crypto::DH::validate_public_key(const big_int &key) const {
     if (key < 2 || key >= _p - 1) return false;
-    return mp::powm(key, _q, _p) == 1;
+    if (_full_validation) return math::mod_pow(key, _q, _p) == 1;
+    return math::legendre_symbol(key, _p) == 1;
 }
 
 const crypto::big_int &crypto::DH::get_shared_secret() const {
@@ -67,22 +85,21 @@ const crypto::big_int &crypto::DH::get_prime_mod() const {
     return _p;
 }
 
-std::pair<crypto::big_int, crypto::big_int> crypto::DH::generate_prime_and_g(size_t bit_len) {
-    static boost::random::mt19937 gen(std::random_device{}());
-    big_int l_border = mp::pow(big_int(2), bit_len - 1);
-    big_int r_border = (l_border * 2) - 1;
-    const boost::random::uniform_int_distribution dist(std::move(l_border), std::move(r_border));
-    primary::MillerRabinTest test;
-    big_int num, q;
-
-    do {
-        num = dist(gen) | 1;
-        q = (num - 1) / 2;
-    } while (!test.is_primary(num, 0.999) || !test.is_primary(q, 0.999));
+std::pair<crypto::big_int, crypto::big_int> crypto::DH::generate_prime_and_g(size_t bit_len, size_t threads_count) {
+    const big_int l_border = mp::pow(big_int(2), bit_len - 1);
+    const primary::BailliePSWTest test;
+    // q = (num - 1) / 2 нечётно только при num = 3 (mod 4). q не просеян, поэтому проверяется первым:
+    // большинство кандидатов отсеивается пробным делением q без возведения в степень
+    const big_int num = primary::PrimeSearch(threads_count).find(
+        l_border, (l_border * 2) - 1, [&test](const big_int &candidate) {
+            return (candidate & 3) == 3 && test.is_primary(big_int((candidate - 1) / 2), 0.999) &&
+                   test.is_primary(candidate, 0.999);
+        });
+    const big_int q = (num - 1) / 2;
 
     big_int g = 2;
     while (g < num - 1) {
-        if (mp::powm(g, q, num) == 1) {
+        if (math::mod_pow(g, q, num) == 1) {
             break;
         }
         ++g;
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "dh.h"
+#include <chrono>
 
 using namespace crypto;
 namespace mp = boost::multiprecision;
@@ -61,6 +62,56 @@ TEST(DHTests, ConstructorWithGandP2048) {
     std::cout << "(P2048) shared bit len: " << mp::msb(alice.get_shared_secret()) + 1 << std::endl;
 }
 
+TEST(DHTests, GeneratorTwoMatchesGroup) {
+    DH alice(DH::Group::ffdhe2048);
+    DH bob(alice.get_generator(), alice.get_prime_mod());
+
+    EXPECT_TRUE(bob.compute_shared_secret(alice.get_public_key()));
+    EXPECT_TRUE(alice.compute_shared_secret(bob.get_public_key()));
+    EXPECT_EQ(alice.get_shared_secret(), bob.get_shared_secret());
+}
+
+TEST(DHTests, PublicKeyValidation) {
+    DH alice(DH::Group::ffdhe2048);
+    DH bob(DH::Group::ffdhe2048);
+    const big_int &p = alice.get_prime_mod();
+    for (bool full: {false, true}) {
+        alice.set_full_validation(full);
+        EXPECT_TRUE(alice.validate_public_key(bob.get_public_key()));
+        EXPECT_TRUE(alice.validate_public_key(big_int(4)));
+        // p = 7 mod 8: 2 - квадратичный вычет, -1 - нет, поэтому p - 2 вне подгруппы порядка q
+        EXPECT_FALSE(alice.validate_public_key(p - 2));
+        EXPECT_FALSE(alice.validate_public_key(big_int(1)));
+        EXPECT_FALSE(alice.validate_public_key(p - 1));
+        EXPECT_FALSE(alice.validate_public_key(p));
+        EXPECT_FALSE(alice.compute_shared_secret(p - 2));
+    }
+}
+
+TEST(DHTests, HandshakeBenchmark) {
+    for (auto group: {DH::Group::ffdhe2048, DH::Group::ffdhe4096}) {
+        DH peer(group);
+        const size_t rounds = 10;
+        for (bool full: {true, false}) {
+            std::chrono::duration<double, std::milli> validation{}, handshake{};
+            for (size_t i = 0; i < rounds; ++i) {
+                const auto start = std::chrono::steady_clock::now();
+                DH self(group);
+                self.set_full_validation(full);
+                EXPECT_TRUE(self.compute_shared_secret(peer.get_public_key()));
+                handshake += std::chrono::steady_clock::now() - start;
+
+                const auto before_validation = std::chrono::steady_clock::now();
+                EXPECT_TRUE(self.validate_public_key(peer.get_public_key()));
+                validation += std::chrono::steady_clock::now() - before_validation;
+            }
+            std::cout << "(group " << static_cast<int>(group) << ", " << (full ? "powm" : "legendre")
+                    << ") validation " << validation.count() / rounds << " ms, handshake "
+                    << handshake.count() / rounds << " ms" << std::endl;
+        }
+    }
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -18,12 +18,24 @@ namespace crypto {
 
         [[nodiscard]] size_t get_block_size() const override;
 
+        /**
+         * Пакетная обработка: на x86-64 блоки идут через векторное ядро (AVX2 или SSE2,
+         * выбирается при запуске), остаток - скалярно
+         */
+        void encrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const override;
+
+        void decrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const override;
+
     private:
         static uint16_t mult(uint16_t a, uint16_t b) noexcept;
 
         static uint16_t inverse(uint16_t num) noexcept;
 
         [[nodiscard]] std::vector<uint8_t> encryption_transform(std::span<const uint8_t> block, bool enc = true) const;
+
+        static void transform_block(const uint8_t *input, uint8_t *output, const uint16_t *keys) noexcept;
+
+        void process_blocks(std::span<const uint8_t> input, std::span<uint8_t> output, bool enc) const;
     };
 }
 
@@ -1,20 +1,29 @@
 #include "idea.h"
+#include "idea_simd.h"
 
 #include <stdexcept>
 #include <tuple>
 
 
-std::vector<uint8_t> crypto::IDEACipher::encryption_transform(std::span<const uint8_t> block, bool enc) const {
-    if (block.size() != 8)
-        throw std::invalid_argument("Invalid block size");
-    if (!_key_is_set)
-        throw std::invalid_argument("Keys is not set");
+namespace {
+    using Kernel = size_t (*)(const uint8_t *, uint8_t *, size_t, const uint16_t *) noexcept;
+
+    Kernel select_kernel() noexcept {
+#if defined(IDEA_SIMD)
+        if (__builtin_cpu_supports("avx2"))
+            return crypto::idea_simd::process_avx2;
+        return crypto::idea_simd::process_sse2;
+#else
+        return nullptr;
+#endif
+    }
+}
 
-    auto keys = (enc ? _enc_keys : _dec_keys).cbegin();
-    uint16_t x1 = (block[0] << 8) | block[1];
-    uint16_t x2 = (block[2] << 8) | block[3];
-    uint16_t x3 = (block[4] << 8) | block[5];
-    uint16_t x4 = (block[6] << 8) | block[7];
+void crypto::IDEACipher::transform_block(const uint8_t *input, uint8_t *output, const uint16_t *keys) noexcept {
+    uint16_t x1 = (input[0] << 8) | input[1];
+    uint16_t x2 = (input[2] << 8) | input[3];
+    uint16_t x3 = (input[4] << 8) | input[5];
+    uint16_t x4 = (input[6] << 8) | input[7];
     for (auto i = 0; i < 8; ++i) {
         x1 = mult(x1, keys[0]);
         x2 = x2 + keys[1];
@@ -34,12 +43,49 @@ std::vector<uint8_t> crypto::IDEACipher::encryption_transform(std::span<const ui
     x1 = mult(x1, keys[0]);
     std::tie(x2, x3) = std::tuple(x3 + keys[1], x2 + keys[2]);
     x4 = mult(x4, keys[3]);
-    return {
-        static_cast<uint8_t>((x1 >> 8) & 0xFF), static_cast<uint8_t>(x1 & 0xFF),
-        static_cast<uint8_t>((x2 >> 8) & 0xFF), static_cast<uint8_t>(x2 & 0xFF),
-        static_cast<uint8_t>((x3 >> 8) & 0xFF), static_cast<uint8_t>(x3 & 0xFF),
-        static_cast<uint8_t>((x4 >> 8) & 0xFF), static_cast<uint8_t>(x4 & 0xFF)
-    };
+
+    output[0] = (x1 >> 8) & 0xFF;
+    output[1] = x1 & 0xFF;
+    output[2] = (x2 >> 8) & 0xFF;
+    output[3] = x2 & 0xFF;
+    output[4] = (x3 >> 8) & 0xFF;
+    output[5] = x3 & 0xFF;
+    output[6] = (x4 >> 8) & 0xFF;
+    output[7] = x4 & 0xFF;
+}
+
+std::vector<uint8_t> crypto::IDEACipher::encryption_transform(std::span<const uint8_t> block, bool enc) const {
+    if (block.size() != 8)
+        throw std::invalid_argument("Invalid block size");
+    if (!_key_is_set)
+        throw std::invalid_argument("Keys is not set");
+
+    std::vector<uint8_t> result(8);
+    transform_block(block.data(), result.data(), (enc ? _enc_keys : _dec_keys).data());
+    return result;
+}
+
+void crypto::IDEACipher::process_blocks(std::span<const uint8_t> input, std::span<uint8_t> output, bool enc) const {
+    if (input.size() % 8 != 0 || output.size() != input.size())
+        throw std::invalid_argument("Invalid block size");
+    if (!_key_is_set)
+        throw std::invalid_argument("Keys is not set");
+
+    static const Kernel kernel = select_kernel();
+    const uint16_t *keys = (enc ? _enc_keys : _dec_keys).data();
+    const size_t blocks_count = input.size() / 8;
+    const size_t processed = kernel ? kernel(input.data(), output.data(), blocks_count, keys) : 0;
+    for (size_t block = processed; block < blocks_count; ++block) {
+        transform_block(input.data() + block * 8, output.data() + block * 8, keys);
+    }
+}
+
+void crypto::IDEACipher::encrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const {
+    process_blocks(input, output, true);
+}
+
+void crypto::IDEACipher::decrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const {
+    process_blocks(input, output, false);
 }
 
 std::vector<uint8_t> crypto::IDEACipher::encrypt(std::span<const uint8_t> block) const {
@@ -104,33 +150,22 @@ void crypto::IDEACipher::set_round_keys(std::span<const uint8_t> encryption_key)
 
 size_t crypto::IDEACipher::get_block_size() const { return 8; }
 
+// 0 трактуется как 2^16. ab mod (2^16 + 1) = lo - hi (+1 при заёме); произведение равно 0 только если
+// один из множителей 0, тогда результат 1 - a - b. Выборы через маску, без условных переходов
 uint16_t crypto::IDEACipher::mult(uint16_t a, uint16_t b) noexcept {
-    if (a == 0)
-        return 0x10001 - b;
-    if (b == 0)
-        return 0x10001 - a;
-    const uint32_t c = a * b;
-    uint32_t res = (c & 0xFFFF) - (c >> 16);
-    if (res >> 16) {
-        res += 0x10001;
-    }
-    return res;
+    const uint32_t c = static_cast<uint32_t>(a) * b;
+    const uint32_t lo = c & 0xFFFF;
+    const uint32_t hi = c >> 16;
+    const uint32_t res = lo - hi + (lo < hi);
+    const uint32_t zero = 0u - (c == 0);
+    return static_cast<uint16_t>((res & ~zero) | ((1u - a - b) & zero));
 }
 
+// По малой теореме Ферма x^-1 = x^(2^16 - 1) mod (2^16 + 1): фиксированная цепочка из 30 умножений
 uint16_t crypto::IDEACipher::inverse(uint16_t num) noexcept {
-    if (num <= 1) return num;
-
-    uint32_t t0 = 0, t1 = 1;
-    uint32_t a = 0x10001;
-    uint16_t b = num;
-    while (b != 1) {
-        uint16_t q = a / b;
-        uint32_t tmp = a - b * q;
-        a = b;
-        b = tmp;
-        tmp = t1;
-        t1 = t0 - q * t1;
-        t0 = tmp;
+    uint16_t res = num;
+    for (size_t i = 0; i < 15; ++i) {
+        res = mult(mult(res, res), num);
     }
-    return (t1 >> 16 ? t1 + 0x10001 : t1) & 0xFFFF;
+    return res;
 }
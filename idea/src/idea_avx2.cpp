@@ -0,0 +1,31 @@
+#include "idea_simd.h"
+#include "idea_simd_kernel.h"
+
+#include <immintrin.h>
+
+// Единица трансляции собирается с -mavx2, вызывается только после проверки поддержки процессором
+namespace {
+    struct Avx2 {
+        using vec = __m256i;
+        static constexpr size_t lanes = 16;
+
+        static vec load(const uint16_t *p) noexcept { return _mm256_load_si256(reinterpret_cast<const __m256i *>(p)); }
+        static void store(uint16_t *p, vec v) noexcept { _mm256_store_si256(reinterpret_cast<__m256i *>(p), v); }
+        static vec zero() noexcept { return _mm256_setzero_si256(); }
+        static vec set1(uint16_t k) noexcept { return _mm256_set1_epi16(static_cast<short>(k)); }
+        static vec add(vec a, vec b) noexcept { return _mm256_add_epi16(a, b); }
+        static vec sub(vec a, vec b) noexcept { return _mm256_sub_epi16(a, b); }
+        static vec subs(vec a, vec b) noexcept { return _mm256_subs_epu16(a, b); }
+        static vec bxor(vec a, vec b) noexcept { return _mm256_xor_si256(a, b); }
+        static vec andnot(vec mask, vec a) noexcept { return _mm256_andnot_si256(mask, a); }
+        static vec mullo(vec a, vec b) noexcept { return _mm256_mullo_epi16(a, b); }
+        static vec mulhi(vec a, vec b) noexcept { return _mm256_mulhi_epu16(a, b); }
+        static vec cmpeq(vec a, vec b) noexcept { return _mm256_cmpeq_epi16(a, b); }
+        static vec select(vec mask, vec a, vec b) noexcept { return _mm256_blendv_epi8(b, a, mask); }
+    };
+}
+
+size_t crypto::idea_simd::process_avx2(const uint8_t *input, uint8_t *output, size_t blocks_count,
+                                       const uint16_t *keys) noexcept {
+    return process_lanes<Avx2>(input, output, blocks_count, keys);
+}
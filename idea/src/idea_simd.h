@@ -0,0 +1,18 @@
+#ifndef IDEA_SIMD_H
+#define IDEA_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace crypto::idea_simd {
+    /**
+     * Векторные ядра IDEA: каждое 16-битное слово блока лежит в отдельной полосе регистра,
+     * поэтому за один проход обрабатывается lanes блоков (SSE2 - 8, AVX2 - 16).
+     * Обрабатывают только целые группы, возвращают число обработанных блоков
+     */
+    size_t process_sse2(const uint8_t *input, uint8_t *output, size_t blocks_count, const uint16_t *keys) noexcept;
+
+    size_t process_avx2(const uint8_t *input, uint8_t *output, size_t blocks_count, const uint16_t *keys) noexcept;
+}
+
+#endif //IDEA_SIMD_H
@@ -0,0 +1,79 @@
+#ifndef IDEA_SIMD_KERNEL_H
+#define IDEA_SIMD_KERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Общее ядро для idea_sse2.cpp и idea_avx2.cpp. Подключается только в эти единицы трансляции:
+ * всё лежит в анонимном пространстве имён, чтобы код, собранный с -mavx2, не попал в другие единицы
+ */
+namespace {
+    /**
+     * Умножение по модулю 2^16 + 1 в каждой полосе без ветвлений (0 означает 2^16):
+     * ab mod (2^16 + 1) = lo - hi, если lo >= hi, иначе lo - hi + 1 (mod 2^16)
+     */
+    template<typename V>
+    typename V::vec mult(typename V::vec x, typename V::vec k) noexcept {
+        const auto zero = V::zero();
+        const auto one = V::set1(1);
+        const auto lo = V::mullo(x, k);
+        const auto hi = V::mulhi(x, k);
+        const auto no_borrow = V::cmpeq(V::subs(hi, lo), zero);
+        auto res = V::add(V::sub(lo, hi), V::andnot(no_borrow, one));
+        res = V::select(V::cmpeq(x, zero), V::sub(one, k), res);
+        return V::select(V::cmpeq(k, zero), V::sub(one, x), res);
+    }
+
+    template<typename V>
+    size_t process_lanes(const uint8_t *input, uint8_t *output, size_t blocks_count, const uint16_t *keys) noexcept {
+        constexpr size_t lanes = V::lanes;
+        const size_t processed = blocks_count - blocks_count % lanes;
+
+        for (size_t block = 0; block < processed; block += lanes) {
+            alignas(32) uint16_t words[4][lanes];
+            const uint8_t *in = input + block * 8;
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                for (size_t w = 0; w < 4; ++w) {
+                    words[w][lane] = static_cast<uint16_t>((in[lane * 8 + 2 * w] << 8) | in[lane * 8 + 2 * w + 1]);
+                }
+            }
+
+            auto x1 = V::load(words[0]);
+            auto x2 = V::load(words[1]);
+            auto x3 = V::load(words[2]);
+            auto x4 = V::load(words[3]);
+            const uint16_t *k = keys;
+            for (size_t round = 0; round < 8; ++round, k += 6) {
+                x1 = mult<V>(x1, V::set1(k[0]));
+                x2 = V::add(x2, V::set1(k[1]));
+                x3 = V::add(x3, V::set1(k[2]));
+                x4 = mult<V>(x4, V::set1(k[3]));
+
+                const auto t0 = mult<V>(V::bxor(x1, x3), V::set1(k[4]));
+                const auto t1 = mult<V>(V::add(t0, V::bxor(x2, x4)), V::set1(k[5]));
+                const auto t2 = V::add(t0, t1);
+                x1 = V::bxor(x1, t1);
+                x4 = V::bxor(x4, t2);
+                const auto tmp = V::bxor(x3, t1);
+                x3 = V::bxor(x2, t2);
+                x2 = tmp;
+            }
+            V::store(words[0], mult<V>(x1, V::set1(k[0])));
+            V::store(words[1], V::add(x3, V::set1(k[1])));
+            V::store(words[2], V::add(x2, V::set1(k[2])));
+            V::store(words[3], mult<V>(x4, V::set1(k[3])));
+
+            uint8_t *out = output + block * 8;
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                for (size_t w = 0; w < 4; ++w) {
+                    out[lane * 8 + 2 * w] = static_cast<uint8_t>(words[w][lane] >> 8);
+                    out[lane * 8 + 2 * w + 1] = static_cast<uint8_t>(words[w][lane]);
+                }
+            }
+        }
+        return processed;
+    }
+}
+
+#endif //IDEA_SIMD_KERNEL_H
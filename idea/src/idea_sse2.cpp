@@ -0,0 +1,33 @@
+#include "idea_simd.h"
+#include "idea_simd_kernel.h"
+
+#include <emmintrin.h>
+
+namespace {
+    struct Sse2 {
+        using vec = __m128i;
+        static constexpr size_t lanes = 8;
+
+        static vec load(const uint16_t *p) noexcept { return _mm_load_si128(reinterpret_cast<const __m128i *>(p)); }
+        static void store(uint16_t *p, vec v) noexcept { _mm_store_si128(reinterpret_cast<__m128i *>(p), v); }
+        static vec zero() noexcept { return _mm_setzero_si128(); }
+        static vec set1(uint16_t k) noexcept { return _mm_set1_epi16(static_cast<short>(k)); }
+        static vec add(vec a, vec b) noexcept { return _mm_add_epi16(a, b); }
+        static vec sub(vec a, vec b) noexcept { return _mm_sub_epi16(a, b); }
+        static vec subs(vec a, vec b) noexcept { return _mm_subs_epu16(a, b); }
+        static vec bxor(vec a, vec b) noexcept { return _mm_xor_si128(a, b); }
+        static vec andnot(vec mask, vec a) noexcept { return _mm_andnot_si128(mask, a); }
+        static vec mullo(vec a, vec b) noexcept { return _mm_mullo_epi16(a, b); }
+        static vec mulhi(vec a, vec b) noexcept { return _mm_mulhi_epu16(a, b); }
+        static vec cmpeq(vec a, vec b) noexcept { return _mm_cmpeq_epi16(a, b); }
+
+        static vec select(vec mask, vec a, vec b) noexcept {
+            return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+        }
+    };
+}
+
+size_t crypto::idea_simd::process_sse2(const uint8_t *input, uint8_t *output, size_t blocks_count,
+                                       const uint16_t *keys) noexcept {
+    return process_lanes<Sse2>(input, output, blocks_count, keys);
+}
@@ -4,6 +4,7 @@
 #include <random>
 #include <fstream>
 #include <filesystem>
+#include <chrono>
 
 namespace crypto::test {
     class CryptoTest : public ::testing::Test {
@@ -199,6 +200,90 @@ namespace crypto::test {
         }
     }
 
+    // Пакетная (векторная) обработка совпадает с поблочной, включая неполные группы и нулевые слова
+    TEST_F(CryptoTest, BatchBlocksMatchSingleBlocks) {
+        const std::vector<std::vector<uint8_t> > keys{test_key, std::vector<uint8_t>(16, 0)};
+        for (const auto &key: keys) {
+            IDEACipher idea;
+            idea.set_round_keys(key);
+
+            for (size_t blocks: {1, 7, 8, 9, 15, 16, 17, 31, 33, 100}) {
+                auto data = generateRandomData(blocks * 8);
+                std::fill_n(data.begin(), 8, 0);
+
+                std::vector<uint8_t> expected;
+                for (size_t offset = 0; offset < data.size(); offset += 8) {
+                    auto block = idea.encrypt(std::span(data).subspan(offset, 8));
+                    expected.insert(expected.end(), block.begin(), block.end());
+                }
+
+                std::vector<uint8_t> encrypted(data.size());
+                idea.encrypt_blocks(data, encrypted);
+                EXPECT_EQ(expected, encrypted) << "Failed for blocks count: " << blocks;
+
+                std::vector<uint8_t> decrypted(data.size());
+                idea.decrypt_blocks(encrypted, decrypted);
+                EXPECT_EQ(data, decrypted) << "Failed for blocks count: " << blocks;
+            }
+        }
+    }
+
+    TEST_F(CryptoTest, BatchThroughputBenchmark) {
+        IDEACipher idea;
+        idea.set_round_keys(test_key);
+        const auto data = generateRandomData(8 << 20);
+        std::vector<uint8_t> output(data.size());
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset < data.size(); offset += 8) {
+            auto block = idea.encrypt(std::span(data).subspan(offset, 8));
+            std::copy(block.begin(), block.end(), output.begin() + offset);
+        }
+        const std::chrono::duration<double> single = std::chrono::steady_clock::now() - start;
+
+        std::vector<uint8_t> batch(data.size());
+        start = std::chrono::steady_clock::now();
+        idea.encrypt_blocks(data, batch);
+        const std::chrono::duration<double> lanes = std::chrono::steady_clock::now() - start;
+
+        EXPECT_EQ(output, batch);
+        std::cout << "IDEA single: " << 8.0 / single.count() << " MB/s, batch: "
+                << 8.0 / lanes.count() << " MB/s" << std::endl;
+    }
+
+    // Эталонный вектор из описания алгоритма: проверяет умножение и обратные ключи расшифрования
+    TEST_F(CryptoTest, KnownAnswerBlock) {
+        IDEACipher idea;
+        idea.set_round_keys(std::vector<uint8_t>{0, 1, 0, 2, 0, 3, 0, 4, 0, 5, 0, 6, 0, 7, 0, 8});
+        const std::vector<uint8_t> plain{0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x03};
+        const std::vector<uint8_t> cipher{0x11, 0xFB, 0xED, 0x2B, 0x01, 0x98, 0x6D, 0xE5};
+
+        EXPECT_EQ(cipher, idea.encrypt(plain));
+        EXPECT_EQ(plain, idea.decrypt(cipher));
+    }
+
+    TEST_F(CryptoTest, ScalarBlockCyclesBenchmark) {
+        IDEACipher idea;
+        idea.set_round_keys(test_key);
+        const size_t blocks = 1 << 18;
+        const auto data = generateRandomData(blocks * 8);
+
+        uint8_t checksum = 0;
+        const auto start = std::chrono::steady_clock::now();
+#if defined(__x86_64__)
+        const auto cycles_start = __builtin_ia32_rdtsc();
+#endif
+        for (size_t offset = 0; offset < data.size(); offset += 8) {
+            checksum ^= idea.encrypt(std::span(data).subspan(offset, 8))[0];
+        }
+#if defined(__x86_64__)
+        const auto cycles = __builtin_ia32_rdtsc() - cycles_start;
+        std::cout << "IDEA scalar: " << static_cast<double>(cycles) / blocks << " cycles/block, ";
+#endif
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << elapsed.count() / blocks << " ns/block (" << int{checksum} << ")" << std::endl;
+    }
+
     // Тест на пустые данные
     TEST_F(CryptoTest, EmptyData) {
         auto idea = std::make_shared<crypto::IDEACipher>();
@@ -4,6 +4,7 @@
 #include <vector>
 #include <cstdint>
 #include <span>
+#include <algorithm>
 
 namespace crypto {
     class IKeyExpansion {
@@ -36,6 +37,26 @@ namespace crypto {
         virtual std::vector<uint8_t> decrypt(std::span<const uint8_t> block) const = 0;
 
         [[nodiscard]] virtual size_t get_block_size() const = 0;
+
+        /**
+         * Пакетная обработка подряд идущих блоков (input.size() кратен размеру блока, output того же размера).
+         * По умолчанию - поблочно; алгоритмы могут обрабатывать несколько блоков одновременно
+         */
+        virtual void encrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const {
+            const size_t block_size = get_block_size();
+            for (size_t offset = 0; offset < input.size(); offset += block_size) {
+                const auto encrypted = encrypt(input.subspan(offset, block_size));
+                std::ranges::copy(encrypted, output.begin() + static_cast<ptrdiff_t>(offset));
+            }
+        }
+
+        virtual void decrypt_blocks(std::span<const uint8_t> input, std::span<uint8_t> output) const {
+            const size_t block_size = get_block_size();
+            for (size_t offset = 0; offset < input.size(); offset += block_size) {
+                const auto decrypted = decrypt(input.subspan(offset, block_size));
+                std::ranges::copy(decrypted, output.begin() + static_cast<ptrdiff_t>(offset));
+            }
+        }
     };
 } // crypto
 #endif //INTERFACES_H
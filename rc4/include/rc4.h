@@ -10,6 +10,16 @@
 
 namespace crypto {
     class RC4 final {
+    public:
+        // Полное состояние генератора ключевого потока (258 байт)
+        struct State {
+            std::array<uint8_t, 256> s_box{};
+            uint8_t i{}, j{};
+
+            bool operator==(const State &) const = default;
+        };
+
+    private:
         class Gen final {
             std::array<uint8_t, 256> _s_box{};
             uint8_t _i{}, _j{};
@@ -25,16 +35,33 @@ namespace crypto {
 
             Gen &operator=(Gen &&) noexcept = default;
 
-            void reset(std::span<const uint8_t> key);
+            // KSA и пропуск первых drop байт ключевого потока (RC4-drop[n])
+            void reset(std::span<const uint8_t> key, size_t drop = 0);
 
             uint8_t operator()() noexcept;
+
+            // Пропуск count байт ключевого потока
+            void discard(uint64_t count) noexcept;
+
+            [[nodiscard]] State state() const noexcept { return {_s_box, _i, _j}; }
+
+            void restore(const State &state) noexcept;
+
+            // Заполнение буфера следующими байтами ключевого потока
+            void fill(std::span<uint8_t> keystream) noexcept;
         };
 
         std::array<uint8_t, 256> _s_box{};
         std::vector<uint8_t> _key{};
         Gen _gen{};
+        size_t _chunk_size{DEFAULT_CHUNK_SIZE};
+        size_t _drop{};
+        uint64_t _checkpoint_interval{};
 
     public:
+        // Размер блока чтения файла по умолчанию
+        static constexpr size_t DEFAULT_CHUNK_SIZE = 4 << 20;
+
         RC4() = default;
 
         RC4(const RC4 &) = delete;
@@ -47,8 +74,45 @@ namespace crypto {
 
         ~RC4() = default;
 
+        // Сохраняет ключ и начинает поток для update заново
         void set_key(std::span<const uint8_t> key);
 
+        /**
+         * Число отбрасываемых байт в начале ключевого потока (RC4-drop[n]), по умолчанию 0.
+         * Действует на все операции, поток update перезапускается
+         */
+        void set_drop(size_t drop);
+
+        [[nodiscard]] size_t get_drop() const noexcept { return _drop; }
+
+        /**
+         * Потоковое шифрование: ключевой поток продолжается между вызовами.
+         * output.size() == input.size(), input и output могут совпадать
+         */
+        void update(std::span<const uint8_t> input, std::span<uint8_t> output);
+
+        std::vector<uint8_t> update(std::span<const uint8_t> input);
+
+        // Перезапуск потока update с текущим ключом
+        void reset();
+
+        // Смена ключа посреди потока: эквивалентно set_key
+        void rekey(std::span<const uint8_t> key) { set_key(key); }
+
+        // Снимок и восстановление позиции потока update
+        [[nodiscard]] State snapshot() const noexcept { return _gen.state(); }
+
+        void restore(const State &state) noexcept { _gen.restore(state); }
+
+        /**
+         * Размер блока, которым файл читается в encrypt_async/decrypt_async.
+         * Память под файловую операцию - три таких блока (два для ввода-вывода, один под ключевой поток)
+         */
+        void set_chunk_size(size_t chunk_size);
+
+        [[nodiscard]] size_t get_chunk_size() const noexcept { return _chunk_size; }
+
+        // Разовые операции: каждый вызов начинает ключевой поток заново и не трогает поток update
         std::vector<uint8_t> encrypt(
             std::span<const uint8_t> input_data
         );
@@ -65,7 +129,45 @@ namespace crypto {
             const std::filesystem::path &input_file, const std::filesystem::path &output_file = {}
         );
 
+        /**
+         * Шаг контрольных точек в байтах (0 - выключено). Если задан, encrypt_async/decrypt_async рядом
+         * с результатом пишут файл checkpoint_path(output) с состоянием генератора на каждой позиции,
+         * кратной шагу, иначе удаляют оставшийся от прежнего результата. В файле хранятся drop и отпечаток
+         * ключа, с другим ключом или drop он отвергается.
+         * Файл контрольных точек равносилен ключу: по нему шифротекст расшифровывается без ключа
+         */
+        void set_checkpoint_interval(uint64_t interval) noexcept { _checkpoint_interval = interval; }
+
+        [[nodiscard]] uint64_t get_checkpoint_interval() const noexcept { return _checkpoint_interval; }
+
+        [[nodiscard]] static std::filesystem::path checkpoint_path(const std::filesystem::path &file);
+
+        /**
+         * Расшифрование length байт файла начиная с offset. Генератор стартует с ближайшей контрольной
+         * точки не дальше offset (без файла контрольных точек - с начала потока)
+         */
+        [[nodiscard]] std::vector<uint8_t> decrypt_range(
+            const std::filesystem::path &input_file, uint64_t offset, size_t length
+        ) const;
+
+        /**
+         * Расшифрование файла целиком: каждый из workers потоков (0 - по числу ядер) начинает со своей
+         * контрольной точки. Без файла контрольных точек равносильно decrypt_async
+         */
+        std::future<std::filesystem::path> decrypt_parallel_async(
+            const std::filesystem::path &input_file, const std::filesystem::path &output_file = {},
+            size_t workers = 0
+        );
+
     private:
+        // Порция ключевого потока, генерируемая за один шаг update
+        static constexpr size_t _stream_batch = 4096;
+
+        // Первые 16 байт ключевого потока без drop: по ним файл контрольных точек сверяется с ключом
+        [[nodiscard]] std::array<uint8_t, 16> key_fingerprint() const;
+
+        // data ^= keystream полосами по 32 байта
+        static void xor_keystream(std::span<uint8_t> data, std::span<const uint8_t> keystream) noexcept;
     };
 }
 
@@ -0,0 +1,42 @@
+#ifndef RC4_BATCH_H
+#define RC4_BATCH_H
+
+#include <cstdint>
+#include <span>
+
+namespace crypto {
+    // Независимый поток RC4: свой ключ, вход и выход одинаковой длины (могут совпадать)
+    struct RC4Job {
+        std::span<const uint8_t> key;
+        std::span<const uint8_t> input;
+        std::span<uint8_t> output;
+    };
+
+    /**
+     * Пакетное шифрование множества коротких потоков под разными ключами.
+     * KSA и генерация ключевого потока LANES потоков идут вперемешку по шагам (S-блоки хранятся
+     * как [256][LANES]), поэтому цепочки зависимых перестановок разных потоков перекрываются в конвейере
+     */
+    class RC4Batch final {
+        size_t _drop{};
+
+    public:
+        static constexpr size_t LANES = 8;
+
+        RC4Batch() = default;
+
+        explicit RC4Batch(size_t drop) : _drop(drop) {}
+
+        // Число отбрасываемых байт в начале каждого потока (RC4-drop[n])
+        void set_drop(size_t drop) noexcept { _drop = drop; }
+
+        [[nodiscard]] size_t get_drop() const noexcept { return _drop; }
+
+        void process(std::span<const RC4Job> jobs) const;
+
+    private:
+        void process_group(std::span<const RC4Job> jobs) const noexcept;
+    };
+}
+
+#endif //RC4_BATCH_H
@@ -1,11 +1,105 @@
 #include "rc4.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 #include <fstream>
 #include <iostream>
 
 
-void crypto::RC4::Gen::reset(std::span<const uint8_t> key) {
+namespace {
+    /*
+     * Файл контрольных точек: сигнатура, шаг, drop, отпечаток ключа, число точек (числа - little-endian),
+     * затем состояния по 258 байт
+     */
+    constexpr std::array<char, 8> CHECKPOINT_MAGIC{'R', 'C', '4', 'C', 'K', 'P', 'T', '2'};
+    constexpr uint64_t CHECKPOINT_HEADER_SIZE = 8 + 8 + 8 + 16 + 8;
+    constexpr uint64_t CHECKPOINT_STATE_SIZE = 256 + 2;
+
+    struct Checkpoints {
+        uint64_t interval{};
+        uint64_t drop{};
+        std::array<uint8_t, 16> fingerprint{};
+        std::vector<crypto::RC4::State> states;
+    };
+
+    void write_u64(std::ostream &out, uint64_t value) {
+        std::array<char, 8> bytes;
+        for (size_t i = 0; i < bytes.size(); ++i) {
+            bytes[i] = static_cast<char>(value >> (8 * i));
+        }
+        out.write(bytes.data(), bytes.size());
+    }
+
+    uint64_t read_u64(std::istream &in) {
+        std::array<char, 8> bytes{};
+        in.read(bytes.data(), bytes.size());
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes.size(); ++i) {
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    void write_checkpoints(const std::filesystem::path &path, const Checkpoints &checkpoints) {
+        std::ofstream out(path, std::ios::binary);
+        if (!out.is_open())
+            throw std::invalid_argument("failed to open checkpoint file");
+
+        out.write(CHECKPOINT_MAGIC.data(), CHECKPOINT_MAGIC.size());
+        write_u64(out, checkpoints.interval);
+        write_u64(out, checkpoints.drop);
+        out.write(reinterpret_cast<const char *>(checkpoints.fingerprint.data()), checkpoints.fingerprint.size());
+        write_u64(out, checkpoints.states.size());
+        for (const auto &state: checkpoints.states) {
+            out.write(reinterpret_cast<const char *>(state.s_box.data()), state.s_box.size());
+            out.put(static_cast<char>(state.i));
+            out.put(static_cast<char>(state.j));
+        }
+    }
+
+    // Пустой результат, если файла нет. Файл другого ключа или drop отвергается
+    Checkpoints read_checkpoints(const std::filesystem::path &path, const std::array<uint8_t, 16> &fingerprint,
+                                 uint64_t drop) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open())
+            return {};
+
+        std::array<char, 8> magic{};
+        in.read(magic.data(), magic.size());
+        if (magic != CHECKPOINT_MAGIC)
+            throw std::runtime_error("invalid checkpoint file");
+
+        Checkpoints checkpoints;
+        checkpoints.interval = read_u64(in);
+        checkpoints.drop = read_u64(in);
+        in.read(reinterpret_cast<char *>(checkpoints.fingerprint.data()), checkpoints.fingerprint.size());
+        const uint64_t count = read_u64(in);
+        // число точек сверяется с размером файла до выделения памяти под них
+        const uint64_t file_size = std::filesystem::file_size(path);
+        if (!in || file_size < CHECKPOINT_HEADER_SIZE)
+            throw std::runtime_error("invalid checkpoint file");
+        const uint64_t body_size = file_size - CHECKPOINT_HEADER_SIZE;
+        if (body_size % CHECKPOINT_STATE_SIZE != 0 || body_size / CHECKPOINT_STATE_SIZE != count)
+            throw std::runtime_error("invalid checkpoint file");
+        if (checkpoints.drop != drop || checkpoints.fingerprint != fingerprint)
+            throw std::runtime_error("checkpoint file was written with another key or drop");
+
+        checkpoints.states.resize(count);
+        for (auto &state: checkpoints.states) {
+            in.read(reinterpret_cast<char *>(state.s_box.data()), state.s_box.size());
+            state.i = static_cast<uint8_t>(in.get());
+            state.j = static_cast<uint8_t>(in.get());
+        }
+        if (!in || checkpoints.interval == 0)
+            throw std::runtime_error("invalid checkpoint file");
+        return checkpoints;
+    }
+}
+
+void crypto::RC4::Gen::reset(std::span<const uint8_t> key, size_t drop) {
     if (!key.size())
         throw std::invalid_argument("Key is empty");
     uint8_t i{}, j{};
@@ -16,6 +110,22 @@ void crypto::RC4::Gen::reset(std::span<const uint8_t> key) {
         std::swap(_s_box[i], _s_box[j]);
     } while (i++ < 255);
     _i = _j = 0;
+    discard(drop);
+}
+
+void crypto::RC4::Gen::discard(uint64_t count) noexcept {
+    std::array<uint8_t, 4096> scratch;
+    while (count != 0) {
+        const size_t step = std::min<uint64_t>(count, scratch.size());
+        fill(std::span(scratch).first(step));
+        count -= step;
+    }
+}
+
+void crypto::RC4::Gen::restore(const State &state) noexcept {
+    _s_box = state.s_box;
+    _i = state.i;
+    _j = state.j;
 }
 
 uint8_t crypto::RC4::Gen::operator()() noexcept {
@@ -25,20 +135,99 @@ uint8_t crypto::RC4::Gen::operator()() noexcept {
     return _s_box[static_cast<uint8_t>(_s_box[_i] + _s_box[_j])];
 }
 
+// Состояние копируется в локальные переменные: иначе запись байта в keystream (uint8_t может ссылаться
+// на что угодно) заставляет компилятор перечитывать S-блок на каждой итерации
+void crypto::RC4::Gen::fill(std::span<uint8_t> keystream) noexcept {
+    auto s_box = _s_box;
+    uint8_t i = _i, j = _j;
+    for (auto &byte: keystream) {
+        ++i;
+        const uint8_t s_i = s_box[i];
+        j += s_i;
+        const uint8_t s_j = s_box[j];
+        s_box[i] = s_j;
+        s_box[j] = s_i;
+        byte = s_box[static_cast<uint8_t>(s_i + s_j)];
+    }
+    _s_box = s_box;
+    _i = i;
+    _j = j;
+}
+
+std::array<uint8_t, 16> crypto::RC4::key_fingerprint() const {
+    Gen gen{};
+    gen.reset(_key);
+    std::array<uint8_t, 16> fingerprint;
+    gen.fill(fingerprint);
+    return fingerprint;
+}
+
+void crypto::RC4::xor_keystream(std::span<uint8_t> data, std::span<const uint8_t> keystream) noexcept {
+    constexpr size_t stride = 32;
+    const size_t full = data.size() - data.size() % stride;
+    for (size_t offset = 0; offset < full; offset += stride) {
+        for (size_t k = 0; k < stride; ++k) {
+            data[offset + k] ^= keystream[offset + k];
+        }
+    }
+    for (size_t k = full; k < data.size(); ++k) {
+        data[k] ^= keystream[k];
+    }
+}
+
 void crypto::RC4::set_key(std::span<const uint8_t> key) {
     if (key.size() == 0 || key.size() > 256)
         throw std::invalid_argument("Invalid key size");
 
     _key = std::vector(key.begin(), key.end());
+    reset();
 }
 
-std::vector<uint8_t> crypto::RC4::encrypt(std::span<const uint8_t> input_data) {
-    std::vector<uint8_t> res;
-    res.reserve(input_data.size());
-    _gen.reset(_key);
-    for (auto byte: input_data) {
-        res.push_back(byte ^ _gen());
+void crypto::RC4::set_drop(size_t drop) {
+    _drop = drop;
+    if (!_key.empty())
+        reset();
+}
+
+void crypto::RC4::reset() {
+    _gen.reset(_key, _drop);
+}
+
+void crypto::RC4::update(std::span<const uint8_t> input, std::span<uint8_t> output) {
+    if (_key.empty())
+        throw std::invalid_argument("Key is not set");
+    if (output.size() != input.size())
+        throw std::invalid_argument("Output size must match input size");
+
+    for (size_t offset = 0; offset < input.size(); offset += _stream_batch) {
+        const size_t count = std::min(_stream_batch, input.size() - offset);
+        std::array<uint8_t, _stream_batch> keystream;
+        _gen.fill(std::span(keystream).first(count));
+        if (output.data() != input.data())
+            std::copy_n(input.begin() + offset, count, output.begin() + offset);
+        xor_keystream(output.subspan(offset, count), keystream);
     }
+}
+
+std::vector<uint8_t> crypto::RC4::update(std::span<const uint8_t> input) {
+    std::vector<uint8_t> res(input.size());
+    update(input, res);
+    return res;
+}
+
+void crypto::RC4::set_chunk_size(size_t chunk_size) {
+    if (chunk_size == 0)
+        throw std::invalid_argument("Chunk size must be positive");
+
+    _chunk_size = chunk_size;
+}
+
+std::vector<uint8_t> crypto::RC4::encrypt(std::span<const uint8_t> input_data) {
+    std::vector<uint8_t> res(input_data.size());
+    Gen gen{};
+    gen.reset(_key, _drop);
+    gen.fill(res);
+    xor_keystream(res, input_data);
     return res;
 }
 
@@ -54,22 +243,94 @@ std::future<std::filesystem::path> crypto::RC4::encrypt_async(const std::filesys
         out_file.replace_extension(".encrypted");
     }
     Gen new_gen{};
-    new_gen.reset(_key);
-    auto task = [input_file, output_file = std::move(out_file), gen = std::move(new_gen)]() mutable {
+    new_gen.reset(_key, _drop);
+    auto task = [input_file, output_file = std::move(out_file), gen = std::move(new_gen),
+                chunk_size = _chunk_size, interval = _checkpoint_interval, drop = _drop,
+                fingerprint = key_fingerprint()]() mutable {
         std::ifstream in(input_file, std::ios::binary);
         std::ofstream out(output_file, std::ios::binary);
         if (!in.is_open())
             throw std::invalid_argument("failed to open input file");
         if (!out.is_open())
             throw std::invalid_argument("failed to open output file");
+        // контрольные точки прежнего содержимого output_file к новому не подходят
+        std::filesystem::remove(checkpoint_path(output_file));
 
-        std::istreambuf_iterator in_it(in);
-        std::istreambuf_iterator<char> end_it;
-        std::ostreambuf_iterator out_it(out);
-        while (in_it != end_it) {
-            *out_it = *in_it ^ gen();
-            ++in_it, ++out_it;
+        std::vector<uint8_t> keystream(chunk_size);
+        // Ключевой поток генерируется отрезками до ближайшей кратной шагу позиции, где снимается состояние
+        Checkpoints checkpoints{interval, drop, fingerprint, {}};
+        uint64_t position = 0;
+        auto generate = [&](std::span<uint8_t> stream) {
+            while (!stream.empty()) {
+                size_t step = stream.size();
+                if (interval != 0) {
+                    if (position % interval == 0)
+                        checkpoints.states.push_back(gen.state());
+                    step = std::min<uint64_t>(step, interval - position % interval);
+                }
+                gen.fill(stream.first(step));
+                stream = stream.subspan(step);
+                position += step;
+            }
+        };
+
+        // Пока текущий блок шифруется и пишется, поток чтения заполняет другой буфер.
+        // ready[k] - буфер k прочитан и ещё не обработан, counts[k] - сколько в нём байт (0 - конец файла).
+        // read_failed - ошибка чтения, после неё поток чтения завершается
+        std::array buffers{std::vector<uint8_t>(chunk_size), std::vector<uint8_t>(chunk_size)};
+        std::array<size_t, 2> counts{};
+        std::array<bool, 2> ready{};
+        bool read_failed = false;
+        std::mutex mutex;
+        std::condition_variable_any cv;
+        // объявлен последним: при выходе по исключению разрушается первым, останавливая и дожидаясь чтение
+        std::jthread reader([&](const std::stop_token &stop) {
+            for (size_t current = 0;; current ^= 1) {
+                {
+                    std::unique_lock lock(mutex);
+                    if (!cv.wait(lock, stop, [&] { return !ready[current]; }))
+                        return;
+                }
+                in.read(reinterpret_cast<char *>(buffers[current].data()), static_cast<std::streamsize>(chunk_size));
+                const auto count = static_cast<size_t>(in.gcount());
+                const bool failed = in.bad();
+                {
+                    std::lock_guard lock(mutex);
+                    counts[current] = count;
+                    ready[current] = true;
+                    read_failed = failed;
+                }
+                cv.notify_all();
+                if (count == 0 || failed)
+                    return;
+            }
+        });
+
+        for (size_t current = 0;; current ^= 1) {
+            size_t count;
+            {
+                std::unique_lock lock(mutex);
+                cv.wait(lock, [&] { return ready[current]; });
+                if (read_failed)
+                    throw std::runtime_error("failed to read input file");
+                count = counts[current];
+            }
+            if (count == 0)
+                break;
+            const std::span chunk = std::span(buffers[current]).first(count);
+            generate(std::span(keystream).first(count));
+            xor_keystream(chunk, keystream);
+            out.write(reinterpret_cast<const char *>(chunk.data()), static_cast<std::streamsize>(count));
+            {
+                std::lock_guard lock(mutex);
+                ready[current] = false;
+            }
+            cv.notify_all();
         }
+        if (!out)
+            throw std::runtime_error("failed to write output file");
+        if (interval != 0)
+            write_checkpoints(checkpoint_path(output_file), checkpoints);
         return output_file;
     };
     return std::async(std::move(task));
@@ -85,3 +346,120 @@ std::future<std::filesystem::path> crypto::RC4::decrypt_async(const std::filesys
     return encrypt_async(input_file, out_file);
 }
 
+
+std::filesystem::path crypto::RC4::checkpoint_path(const std::filesystem::path &file) {
+    auto path = file;
+    path += ".ckpt";
+    return path;
+}
+
+std::vector<uint8_t> crypto::RC4::decrypt_range(const std::filesystem::path &input_file, uint64_t offset,
+                                                size_t length) const {
+    if (_key.empty())
+        throw std::invalid_argument("Key is not set");
+    std::ifstream in(input_file, std::ios::binary);
+    if (!in.is_open())
+        throw std::invalid_argument("failed to open input file");
+
+    const uint64_t file_size = std::filesystem::file_size(input_file);
+    if (offset >= file_size)
+        return {};
+    length = static_cast<size_t>(std::min<uint64_t>(length, file_size - offset));
+
+    const auto checkpoints = read_checkpoints(checkpoint_path(input_file), key_fingerprint(), _drop);
+    Gen gen{};
+    uint64_t position = 0;
+    if (checkpoints.states.empty()) {
+        gen.reset(_key, _drop);
+    }
+    else {
+        const auto index = std::min<uint64_t>(offset / checkpoints.interval, checkpoints.states.size() - 1);
+        gen.restore(checkpoints.states[index]);
+        position = index * checkpoints.interval;
+    }
+    gen.discard(offset - position);
+
+    std::vector<uint8_t> res(length);
+    in.seekg(static_cast<std::streamoff>(offset));
+    in.read(reinterpret_cast<char *>(res.data()), static_cast<std::streamsize>(length));
+    if (!in)
+        throw std::runtime_error("failed to read input file");
+
+    std::vector<uint8_t> keystream(res.size());
+    gen.fill(keystream);
+    xor_keystream(res, keystream);
+    return res;
+}
+
+std::future<std::filesystem::path> crypto::RC4::decrypt_parallel_async(const std::filesystem::path &input_file,
+                                                                       const std::filesystem::path &output_file,
+                                                                       size_t workers) {
+    auto checkpoints = read_checkpoints(checkpoint_path(input_file), key_fingerprint(), _drop);
+    if (checkpoints.states.empty())
+        return decrypt_async(input_file, output_file);
+
+    auto out_file = output_file;
+    if (output_file.empty()) {
+        out_file = input_file;
+        out_file.replace_extension(".decrypted");
+    }
+    if (workers == 0)
+        workers = std::max(1u, std::thread::hardware_concurrency());
+
+    auto task = [input_file, output_file = std::move(out_file), checkpoints = std::move(checkpoints),
+                workers, chunk_size = _chunk_size] {
+        const uint64_t file_size = std::filesystem::file_size(input_file);
+        {
+            std::ofstream out(output_file, std::ios::binary | std::ios::trunc);
+            if (!out.is_open())
+                throw std::invalid_argument("failed to open output file");
+        }
+        std::filesystem::remove(checkpoint_path(output_file));
+        std::filesystem::resize_file(output_file, file_size);
+
+        // Отрезок k: [k * interval, (k + 1) * interval), последний - до конца файла
+        const uint64_t segments = std::min<uint64_t>(checkpoints.states.size(),
+                                                     (file_size + checkpoints.interval - 1) / checkpoints.interval);
+        auto worker = [&](size_t first) {
+            std::ifstream in(input_file, std::ios::binary);
+            std::fstream out(output_file, std::ios::binary | std::ios::in | std::ios::out);
+            if (!in.is_open() || !out.is_open())
+                throw std::invalid_argument("failed to open file");
+
+            std::vector<uint8_t> buffer(std::min<uint64_t>(chunk_size, checkpoints.interval));
+            std::vector<uint8_t> keystream(buffer.size());
+            for (uint64_t segment = first; segment < segments; segment += workers) {
+                Gen gen{};
+                gen.restore(checkpoints.states[segment]);
+                uint64_t position = segment * checkpoints.interval;
+                const uint64_t end = segment + 1 == segments
+                                         ? file_size
+                                         : std::min(file_size, position + checkpoints.interval);
+                in.seekg(static_cast<std::streamoff>(position));
+                out.seekp(static_cast<std::streamoff>(position));
+                while (position < end) {
+                    const size_t count = std::min<uint64_t>(buffer.size(), end - position);
+                    const std::span chunk = std::span(buffer).first(count);
+                    in.read(reinterpret_cast<char *>(chunk.data()), static_cast<std::streamsize>(count));
+                    gen.fill(std::span(keystream).first(count));
+                    xor_keystream(chunk, keystream);
+                    out.write(reinterpret_cast<const char *>(chunk.data()), static_cast<std::streamsize>(count));
+                    position += count;
+                }
+            }
+            if (!in || !out)
+                throw std::runtime_error("failed to decrypt file");
+        };
+
+        std::vector<std::future<void> > futures;
+        for (size_t i = 1; i < std::min<uint64_t>(workers, segments); ++i) {
+            futures.push_back(std::async(std::launch::async, worker, i));
+        }
+        worker(0);
+        for (auto &future: futures) {
+            future.get();
+        }
+        return output_file;
+    };
+    return std::async(std::launch::async, std::move(task));
+}
@@ -0,0 +1,74 @@
+#include "rc4_batch.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+void crypto::RC4Batch::process(std::span<const RC4Job> jobs) const {
+    for (const auto &job: jobs) {
+        if (job.key.empty() || job.key.size() > 256)
+            throw std::invalid_argument("Invalid key size");
+        if (job.output.size() != job.input.size())
+            throw std::invalid_argument("Output size must match input size");
+    }
+
+    for (size_t offset = 0; offset < jobs.size(); offset += LANES) {
+        process_group(jobs.subspan(offset, std::min(LANES, jobs.size() - offset)));
+    }
+}
+
+void crypto::RC4Batch::process_group(std::span<const RC4Job> jobs) const noexcept {
+    const size_t lanes = jobs.size();
+    std::array<std::array<uint8_t, LANES>, 256> s_box;
+    std::array<uint8_t, LANES> i{}, j{};
+
+    for (size_t x = 0; x < 256; ++x) {
+        s_box[x].fill(static_cast<uint8_t>(x));
+    }
+
+    // KSA: на шаге x позиция ключа у каждого потока своя (x mod длина ключа)
+    std::array<size_t, LANES> key_pos{};
+    for (size_t x = 0; x < 256; ++x) {
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            const auto &key = jobs[lane].key;
+            const uint8_t s_x = s_box[x][lane];
+            j[lane] += s_x + key[key_pos[lane]];
+            key_pos[lane] = key_pos[lane] + 1 == key.size() ? 0 : key_pos[lane] + 1;
+            s_box[x][lane] = s_box[j[lane]][lane];
+            s_box[j[lane]][lane] = s_x;
+        }
+    }
+    j.fill(0);
+
+    auto step = [&](size_t lane) {
+        ++i[lane];
+        const uint8_t s_i = s_box[i[lane]][lane];
+        j[lane] += s_i;
+        const uint8_t s_j = s_box[j[lane]][lane];
+        s_box[i[lane]][lane] = s_j;
+        s_box[j[lane]][lane] = s_i;
+        return s_box[static_cast<uint8_t>(s_i + s_j)][lane];
+    };
+
+    for (size_t n = 0; n < _drop; ++n) {
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            step(lane);
+        }
+    }
+
+    // Общая часть всех потоков - вперемешку, хвосты более длинных потоков - по одному
+    size_t common = jobs[0].input.size();
+    for (size_t lane = 1; lane < lanes; ++lane) {
+        common = std::min(common, jobs[lane].input.size());
+    }
+    for (size_t pos = 0; pos < common; ++pos) {
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            jobs[lane].output[pos] = jobs[lane].input[pos] ^ step(lane);
+        }
+    }
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        for (size_t pos = common; pos < jobs[lane].input.size(); ++pos) {
+            jobs[lane].output[pos] = jobs[lane].input[pos] ^ step(lane);
+        }
+    }
+}
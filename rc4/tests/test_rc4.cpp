@@ -1,9 +1,12 @@
 #include "rc4.h"
+#include "rc4_batch.h"
 #include <gtest/gtest.h>
 #include <fstream>
 #include <filesystem>
 #include <vector>
 #include <algorithm>
+#include <chrono>
+#include <random>
 
 class RC4Test : public ::testing::Test {
 protected:
@@ -194,6 +197,290 @@ TEST_F(RC4Test, EncryptionActuallyChangesData) {
     EXPECT_TRUE(data_changed) << "Encryption should change the data";
 }
 
+TEST_F(RC4Test, KnownAnswer) {
+    const std::string key = "Key";
+    const std::string text = "Plaintext";
+    const std::vector<uint8_t> expected = {0xBB, 0xF3, 0x16, 0xE8, 0xD9, 0x40, 0xAF, 0x0A, 0xD3};
+
+    rc4.set_key(std::span(reinterpret_cast<const uint8_t *>(key.data()), key.size()));
+    EXPECT_EQ(expected, rc4.encrypt(std::span(reinterpret_cast<const uint8_t *>(text.data()), text.size())));
+}
+
+// Файл обрабатывается блоками: результат не должен зависеть от границ блоков
+TEST_F(RC4Test, ChunkedFileMatchesInMemory) {
+    std::vector<uint8_t> data(100'003);
+    std::mt19937 gen(42);
+    std::ranges::generate(data, [&gen] { return static_cast<uint8_t>(gen()); });
+    {
+        std::ofstream out("test_files/chunked.bin", std::ios::binary);
+        out.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    rc4.set_key(std::vector<uint8_t>{0x01, 0x02, 0x03});
+    const auto expected = rc4.encrypt(data);
+    for (size_t chunk_size: {1ul, 31ul, 4103ul, 1ul << 20}) {
+        rc4.set_chunk_size(chunk_size);
+        auto encrypted_path = rc4.encrypt_async("test_files/chunked.bin").get();
+
+        std::ifstream encrypted(encrypted_path, std::ios::binary);
+        std::vector<uint8_t> actual{std::istreambuf_iterator<char>(encrypted), std::istreambuf_iterator<char>()};
+        EXPECT_EQ(expected, actual) << "Failed for chunk size: " << chunk_size;
+    }
+    EXPECT_THROW(rc4.set_chunk_size(0), std::invalid_argument);
+
+    // ошибка чтения (каталог вместо файла) не выдаётся за конец файла
+    EXPECT_THROW(rc4.encrypt_async("test_files", "test_files/dir.encrypted").get(), std::runtime_error);
+    std::filesystem::remove("test_files/dir.encrypted");
+
+    std::filesystem::remove("test_files/chunked.bin");
+    std::filesystem::remove("test_files/chunked.encrypted");
+}
+
+TEST_F(RC4Test, FileThroughputBenchmark) {
+    constexpr size_t size = 64 << 20;
+    {
+        std::vector<uint8_t> data(size, 0x5A);
+        std::ofstream out("test_files/bench.bin", std::ios::binary);
+        out.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    const std::vector<uint8_t> key{0x12, 0x23, 0x34, 0x56};
+    rc4.set_key(key);
+    auto start = std::chrono::steady_clock::now();
+    rc4.encrypt_async("test_files/bench.bin").get();
+    const std::chrono::duration<double> chunked = std::chrono::steady_clock::now() - start;
+
+    // прежний путь: побайтовые istreambuf_iterator/ostreambuf_iterator и вызов генератора на каждый байт.
+    // Gen::operator() определён в rc4.cpp и в цикл не встраивался, поэтому здесь он тоже noinline
+    struct ByteGen {
+        std::array<uint8_t, 256> s_box{};
+        uint8_t i{}, j{};
+
+        [[gnu::noinline]] uint8_t operator()() {
+            ++i;
+            j += s_box[i];
+            std::swap(s_box[i], s_box[j]);
+            return s_box[static_cast<uint8_t>(s_box[i] + s_box[j])];
+        }
+    } byte_gen;
+    for (size_t k = 0; k < 256; ++k) byte_gen.s_box[k] = static_cast<uint8_t>(k);
+    for (size_t k = 0, j = 0; k < 256; ++k) {
+        j = (j + byte_gen.s_box[k] + key[k % key.size()]) & 0xFF;
+        std::swap(byte_gen.s_box[k], byte_gen.s_box[j]);
+    }
+    start = std::chrono::steady_clock::now();
+    {
+        std::ifstream in("test_files/bench.bin", std::ios::binary);
+        std::ofstream out("test_files/bench.bytewise", std::ios::binary);
+        std::istreambuf_iterator in_it(in);
+        std::istreambuf_iterator<char> end_it;
+        std::ostreambuf_iterator out_it(out);
+        while (in_it != end_it) {
+            *out_it = static_cast<char>(*in_it ^ byte_gen());
+            ++in_it, ++out_it;
+        }
+    }
+    const std::chrono::duration<double> bytewise = std::chrono::steady_clock::now() - start;
+
+    std::ifstream chunked_file("test_files/bench.encrypted", std::ios::binary);
+    std::ifstream bytewise_file("test_files/bench.bytewise", std::ios::binary);
+    EXPECT_TRUE(std::equal(std::istreambuf_iterator<char>(chunked_file), std::istreambuf_iterator<char>(),
+                           std::istreambuf_iterator<char>(bytewise_file), std::istreambuf_iterator<char>()));
+    std::cout << "RC4 file: chunked " << (size >> 20) / chunked.count() << " MB/s, byte-wise iterators "
+            << (size >> 20) / bytewise.count() << " MB/s" << std::endl;
+
+    for (const auto *path: {"test_files/bench.bin", "test_files/bench.encrypted", "test_files/bench.bytewise"}) {
+        std::filesystem::remove(path);
+    }
+}
+
+// Поток, зашифрованный частями через update, совпадает с разовым шифрованием
+TEST_F(RC4Test, StreamUpdateContinuesKeystream) {
+    std::vector<uint8_t> data(10'000);
+    std::mt19937 gen(7);
+    std::ranges::generate(data, [&gen] { return static_cast<uint8_t>(gen()); });
+
+    rc4.set_key(std::vector<uint8_t>{0x0A, 0x0B, 0x0C});
+    const auto expected = rc4.encrypt(data);
+
+    std::vector<uint8_t> actual;
+    for (size_t offset = 0, step = 1; offset < data.size(); offset += step, step = step * 3 % 5001 + 1) {
+        const auto part = rc4.update(std::span(data).subspan(offset, std::min(step, data.size() - offset)));
+        actual.insert(actual.end(), part.begin(), part.end());
+    }
+    EXPECT_EQ(expected, actual);
+
+    rc4.reset();
+    std::vector<uint8_t> in_place = data;
+    rc4.update(in_place, in_place);
+    EXPECT_EQ(expected, in_place);
+}
+
+TEST_F(RC4Test, SnapshotRestoreResumesStream) {
+    const std::vector<uint8_t> data(1000, 0x33);
+    rc4.set_key(std::vector<uint8_t>{0x01, 0x02});
+    const auto expected = rc4.encrypt(data);
+
+    rc4.update(std::span(data).first(400));
+    const auto state = rc4.snapshot();
+    const auto tail = rc4.update(std::span(data).subspan(400));
+
+    rc4.rekey(std::vector<uint8_t>{0x09});
+    rc4.restore(state);
+    EXPECT_EQ(state, rc4.snapshot());
+    EXPECT_EQ(tail, rc4.update(std::span(data).subspan(400)));
+    EXPECT_TRUE(std::equal(tail.begin(), tail.end(), expected.begin() + 400));
+}
+
+TEST_F(RC4Test, DropDiscardsKeystreamPrefix) {
+    const std::vector<uint8_t> zeros(1024 + 100, 0);
+    rc4.set_key(std::vector<uint8_t>{0x05, 0x06, 0x07});
+    const auto full = rc4.encrypt(zeros);
+
+    rc4.set_drop(1024);
+    const auto dropped = rc4.encrypt(std::span(zeros).first(100));
+    EXPECT_TRUE(std::equal(dropped.begin(), dropped.end(), full.begin() + 1024));
+    EXPECT_EQ(dropped, rc4.update(std::span(zeros).first(100)));
+}
+
+TEST_F(RC4Test, UpdateWithoutKeyThrows) {
+    std::vector<uint8_t> data(4);
+    EXPECT_THROW(rc4.update(data), std::invalid_argument);
+    rc4.set_key(std::vector<uint8_t>{0x01});
+    std::vector<uint8_t> output(3);
+    EXPECT_THROW(rc4.update(data, output), std::invalid_argument);
+}
+
+// Расшифрование отрезков и параллельное расшифрование по контрольным точкам
+TEST_F(RC4Test, CheckpointRandomAccessDecryption) {
+    std::vector<uint8_t> data(100'003);
+    std::mt19937 gen(3);
+    std::ranges::generate(data, [&gen] { return static_cast<uint8_t>(gen()); });
+    {
+        std::ofstream out("test_files/ckpt.bin", std::ios::binary);
+        out.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    rc4.set_key(std::vector<uint8_t>{0x21, 0x22, 0x23});
+    rc4.set_drop(768);
+    rc4.set_chunk_size(7000);
+    const auto encrypted_path = rc4.encrypt_async("test_files/ckpt.bin").get();
+    EXPECT_FALSE(std::filesystem::exists(crypto::RC4::checkpoint_path(encrypted_path)));
+    const auto without_checkpoints = rc4.decrypt_range(encrypted_path, 54'321, 1000);
+    EXPECT_TRUE(std::equal(without_checkpoints.begin(), without_checkpoints.end(), data.begin() + 54'321));
+
+    rc4.set_checkpoint_interval(10'000);
+    rc4.encrypt_async("test_files/ckpt.bin").get();
+    ASSERT_TRUE(std::filesystem::exists(crypto::RC4::checkpoint_path(encrypted_path)));
+
+    for (auto [offset, length]: std::vector<std::pair<uint64_t, size_t> >{
+             {0, 10}, {9'999, 2}, {10'000, 1}, {54'321, 20'000}, {99'990, 100}, {200'000, 5}, {1ull << 62, 5}
+         }) {
+        const auto part = rc4.decrypt_range(encrypted_path, offset, length);
+        const size_t expected_size = offset < data.size() ? std::min(length, data.size() - offset) : 0;
+        ASSERT_EQ(expected_size, part.size()) << "offset: " << offset;
+        EXPECT_TRUE(std::equal(part.begin(), part.end(), data.begin() + offset)) << "offset: " << offset;
+    }
+
+    for (size_t workers: {1, 3, 16}) {
+        const auto decrypted_path = rc4.decrypt_parallel_async(encrypted_path, "test_files/ckpt.dec", workers).get();
+        std::ifstream decrypted(decrypted_path, std::ios::binary);
+        std::vector<uint8_t> actual{std::istreambuf_iterator<char>(decrypted), std::istreambuf_iterator<char>()};
+        EXPECT_EQ(data, actual) << "workers: " << workers;
+    }
+
+    // контрольные точки другого ключа или drop отвергаются
+    crypto::RC4 other;
+    other.set_key(std::vector<uint8_t>{0x21, 0x22, 0x24});
+    other.set_drop(768);
+    EXPECT_THROW(static_cast<void>(other.decrypt_range(encrypted_path, 0, 10)), std::runtime_error);
+    other.set_key(std::vector<uint8_t>{0x21, 0x22, 0x23});
+    other.set_drop(0);
+    EXPECT_THROW(other.decrypt_parallel_async(encrypted_path).get(), std::runtime_error);
+
+    // число точек, не совпадающее с размером файла, отвергается до выделения памяти
+    const auto checkpoint_file = crypto::RC4::checkpoint_path(encrypted_path);
+    std::filesystem::copy_file(checkpoint_file, "test_files/ckpt.saved");
+    {
+        std::fstream corrupt(checkpoint_file, std::ios::binary | std::ios::in | std::ios::out);
+        corrupt.seekp(40);
+        const std::array<char, 8> huge{0, 0, 0, 0, 0, 0, 0, 0x10};
+        corrupt.write(huge.data(), huge.size());
+    }
+    EXPECT_THROW(static_cast<void>(rc4.decrypt_range(encrypted_path, 0, 10)), std::runtime_error);
+    std::filesystem::rename("test_files/ckpt.saved", checkpoint_file);
+
+    // без контрольных точек прежний файл точек удаляется
+    rc4.set_checkpoint_interval(0);
+    rc4.encrypt_async("test_files/ckpt.bin").get();
+    EXPECT_FALSE(std::filesystem::exists(checkpoint_file));
+
+    for (const auto *path: {"test_files/ckpt.bin", "test_files/ckpt.encrypted", "test_files/ckpt.encrypted.ckpt",
+                            "test_files/ckpt.dec"}) {
+        std::filesystem::remove(path);
+    }
+}
+
+// Пакетная обработка независимых потоков совпадает с поштучной, включая разные длины ключей и данных
+TEST_F(RC4Test, BatchStreamsMatchSingleStreams) {
+    std::mt19937 gen(11);
+    std::vector<std::vector<uint8_t> > keys, inputs, outputs;
+    for (size_t n = 0; n < 21; ++n) {
+        keys.emplace_back(1 + gen() % 256);
+        inputs.emplace_back(gen() % 300);
+        std::ranges::generate(keys.back(), [&gen] { return static_cast<uint8_t>(gen()); });
+        std::ranges::generate(inputs.back(), [&gen] { return static_cast<uint8_t>(gen()); });
+        outputs.emplace_back(inputs.back().size());
+    }
+
+    for (size_t drop: {0, 256}) {
+        std::vector<crypto::RC4Job> jobs;
+        for (size_t n = 0; n < keys.size(); ++n) {
+            jobs.push_back({keys[n], inputs[n], outputs[n]});
+        }
+        crypto::RC4Batch(drop).process(jobs);
+
+        rc4.set_drop(drop);
+        for (size_t n = 0; n < keys.size(); ++n) {
+            rc4.set_key(keys[n]);
+            EXPECT_EQ(rc4.encrypt(inputs[n]), outputs[n]) << "stream: " << n << ", drop: " << drop;
+        }
+    }
+
+    std::vector<uint8_t> short_output(1);
+    const std::vector<crypto::RC4Job> invalid{{keys[0], inputs[0], short_output}};
+    EXPECT_THROW(crypto::RC4Batch().process(invalid), std::invalid_argument);
+}
+
+TEST_F(RC4Test, BatchStreamsBenchmark) {
+    constexpr size_t streams = 20'000;
+    std::vector<std::vector<uint8_t> > keys(streams, std::vector<uint8_t>(16));
+    std::vector<std::vector<uint8_t> > data(streams, std::vector<uint8_t>(64, 0x42));
+    std::mt19937 gen(5);
+    for (auto &key: keys) {
+        std::ranges::generate(key, [&gen] { return static_cast<uint8_t>(gen()); });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t n = 0; n < streams; ++n) {
+        rc4.set_key(keys[n]);
+        rc4.update(data[n], data[n]);
+    }
+    const std::chrono::duration<double> single = std::chrono::steady_clock::now() - start;
+
+    std::vector<crypto::RC4Job> jobs;
+    for (size_t n = 0; n < streams; ++n) {
+        jobs.push_back({keys[n], data[n], data[n]});
+    }
+    start = std::chrono::steady_clock::now();
+    crypto::RC4Batch().process(jobs);
+    const std::chrono::duration<double> batch = std::chrono::steady_clock::now() - start;
+
+    EXPECT_TRUE(std::ranges::all_of(data, [](const auto &d) { return std::ranges::all_of(d, [](auto b) { return b == 0x42; }); }));
+    std::cout << "RC4 streams (16-byte key, 64 bytes): single " << streams / single.count() << "/s, batch "
+            << streams / batch.count() << "/s" << std::endl;
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
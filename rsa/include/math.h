@@ -1,5 +1,11 @@
 #ifndef _MATH_H_
 #define _MATH_H_
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
 #include <boost/multiprecision/cpp_int.hpp>
 #include <boost/multiprecision/gmp.hpp>
 
@@ -10,74 +16,404 @@ namespace crypto {
 }
 
 namespace crypto::math {
-    template<typename T, typename U>
-    inline T mod_pow(T a_, U pow_, const U &mod_) {
-        if (pow_ < 0) {
+    namespace detail {
+        /**
+         * Арифметика Монтгомери по нечётному модулю n, R = 2^k, где k - число бит n.
+         * Умножение без деления: reduce(t) = t * R^-1 mod n
+         */
+        template<typename T>
+        class Montgomery {
+            T _n;
+            T _n_prime; // -n^-1 mod R
+            T _mask; // R - 1
+            size_t _bits;
+
+        public:
+            explicit Montgomery(const T &n) : _n(n), _bits(mp::msb(n) + 1) {
+                const T r = T(1) << _bits;
+                _mask = r - 1;
+                // Итерация Ньютона x = x(2 - nx) mod R удваивает число верных младших бит обратного
+                T inv = 1;
+                for (size_t correct = 1; correct < _bits; correct *= 2) {
+                    const T t = (_n * inv) & _mask;
+                    inv = (inv * ((r + 2 - t) & _mask)) & _mask;
+                }
+                _n_prime = (r - inv) & _mask;
+            }
+
+            [[nodiscard]] T reduce(const T &t) const {
+                const T m = ((t & _mask) * _n_prime) & _mask;
+                T u = (t + m * _n) >> _bits;
+                if (u >= _n) u -= _n;
+                return u;
+            }
+
+            [[nodiscard]] T to_form(const T &a) const { return (a << _bits) % _n; }
+
+            [[nodiscard]] T from_form(const T &a) const { return reduce(a); }
+
+            [[nodiscard]] T mul(const T &a, const T &b) const { return reduce(a * b); }
+        };
+
+        /**
+         * Монтгомери для нечётного модуля n < 2^64 на 128-битных произведениях, R = 2^64.
+         * reduce(t) = hi(t) - hi(m * n), m = lo(t) * n^-1 mod R: переполнения нет при любом n < 2^64
+         */
+        class Montgomery64 {
+            uint64_t _n;
+            uint64_t _n_inv; // n^-1 mod R
+            uint64_t _r2; // R^2 mod n
+
+        public:
+            explicit Montgomery64(uint64_t n) noexcept : _n(n), _n_inv(n) {
+                // n * n = 1 (mod 8), каждая итерация Ньютона удваивает число верных бит: 3 -> 6 -> ... -> 96
+                for (int i = 0; i < 5; ++i) _n_inv *= 2 - n * _n_inv;
+                const uint64_t r = (0 - n) % n;
+                _r2 = static_cast<uint64_t>(static_cast<unsigned __int128>(r) * r % n);
+            }
+
+            [[nodiscard]] uint64_t reduce(unsigned __int128 t) const noexcept {
+                const uint64_t m = static_cast<uint64_t>(t) * _n_inv;
+                const auto hi = static_cast<uint64_t>(t >> 64);
+                const auto mn_hi = static_cast<uint64_t>(static_cast<unsigned __int128>(m) * _n >> 64);
+                return hi >= mn_hi ? hi - mn_hi : hi - mn_hi + _n;
+            }
+
+            [[nodiscard]] uint64_t mul(uint64_t a, uint64_t b) const noexcept {
+                return reduce(static_cast<unsigned __int128>(a) * b);
+            }
+
+            [[nodiscard]] uint64_t to_form(uint64_t a) const noexcept { return mul(a % _n, _r2); }
+
+            [[nodiscard]] uint64_t from_form(uint64_t a) const noexcept { return reduce(a); }
+
+            [[nodiscard]] uint64_t pow(uint64_t base, uint64_t exp) const noexcept {
+                uint64_t res = to_form(1);
+                for (; exp; exp >>= 1) {
+                    if (exp & 1) res = mul(res, base);
+                    base = mul(base, base);
+                }
+                return res;
+            }
+        };
+
+        /**
+         * Возведение в степень скользящим окном: нечётные степени base^1, base^3, ... base^(2^w - 1)
+         * вычисляются заранее, на каждое окно - w возведений в квадрат и одно умножение
+         */
+        template<typename T, typename Mul>
+        T sliding_window_pow(const T &base, const T &pow, T one, Mul &&mul) {
+            if (pow == 0) return one;
+
+            const auto top = static_cast<long long>(mp::msb(pow));
+            const size_t window = top < 24 ? 1 : top < 80 ? 3 : top < 240 ? 4 : top < 672 ? 5 : 6;
+            std::vector<T> odd_powers(size_t{1} << (window - 1));
+            odd_powers[0] = base;
+            if (odd_powers.size() > 1) {
+                const T square = mul(base, base);
+                for (size_t i = 1; i < odd_powers.size(); ++i) {
+                    odd_powers[i] = mul(odd_powers[i - 1], square);
+                }
+            }
+
+            T res = std::move(one);
+            for (long long i = top; i >= 0;) {
+                if (!mp::bit_test(pow, static_cast<unsigned>(i))) {
+                    res = mul(res, res);
+                    --i;
+                    continue;
+                }
+                // Окно [j, i] заканчивается единичным битом
+                long long j = std::max(i - static_cast<long long>(window) + 1, 0ll);
+                while (!mp::bit_test(pow, static_cast<unsigned>(j))) ++j;
+                size_t value = 0;
+                for (long long k = i; k >= j; --k) {
+                    res = mul(res, res);
+                    value = (value << 1) | static_cast<size_t>(mp::bit_test(pow, static_cast<unsigned>(k)));
+                }
+                res = mul(res, odd_powers[value >> 1]);
+                i = j - 1;
+            }
+            return res;
+        }
+    }
+
+    /**
+     * a^pow mod mod для big_int: mpz_powm на самих значениях, без копий и преобразований
+     */
+    inline big_int mod_pow(const big_int &a, const big_int &pow, const big_int &mod) {
+        if (pow < 0) {
             throw std::invalid_argument("степень должна быть положительной");
         }
-        T a(a_.str());
-        T pow(pow_.str());
-        T mod(mod_.str());
-        a = (a % mod + mod) % mod;
-        T res = 1;
-        while (pow > 0) {
-            if (pow & 1) {
-                res = (res * a) % mod;
+        if (mod <= 0) {
+            throw std::invalid_argument("модуль должен быть положительным");
+        }
+        big_int res;
+        mpz_powm(res.backend().data(), a.backend().data(), pow.backend().data(), mod.backend().data());
+        return res;
+    }
+
+    /**
+     * То же за время, не зависящее от показателя (mpz_powm_sec) - для секретных показателей.
+     * Модуль должен быть нечётным
+     */
+    inline big_int mod_pow_sec(const big_int &a, const big_int &pow, const big_int &mod) {
+        if (pow <= 0) {
+            return mod_pow(a, pow, mod);
+        }
+        if (mod <= 0 || (mod & 1) == 0) {
+            throw std::invalid_argument("модуль должен быть нечётным");
+        }
+        big_int res;
+        mpz_powm_sec(res.backend().data(), a.backend().data(), pow.backend().data(), mod.backend().data());
+        return res;
+    }
+
+    /**
+     * Вариант для остальных типов (например, cpp_int): скользящее окно, для нечётного модуля -
+     * в форме Монтгомери
+     */
+    template<typename T>
+    T mod_pow(const T &a, const T &pow, const T &mod) {
+        if (pow < 0) {
+            throw std::invalid_argument("степень должна быть положительной");
+        }
+        if (mod <= 0) {
+            throw std::invalid_argument("модуль должен быть положительным");
+        }
+        T base = a % mod;
+        if (base < 0) base += mod;
+
+        if (mod > 1 && mp::bit_test(mod, 0)) {
+            const detail::Montgomery<T> ctx(mod);
+            const auto mul = [&ctx](const T &x, const T &y) { return ctx.mul(x, y); };
+            return ctx.from_form(detail::sliding_window_pow(ctx.to_form(base), pow, ctx.to_form(T(1)), mul));
+        }
+        const auto mul = [&mod](const T &x, const T &y) { return T(x * y % mod); };
+        return detail::sliding_window_pow(base, pow, T(T(1) % mod), mul);
+    }
+
+    /**
+     * Контекст base^exp mod mod с фиксированными основанием и модулем (комб Лим-Ли) для показателей до
+     * max_exp_bits бит. Показатель раскладывается на rows строк по cols = ceil(max_exp_bits / rows) бит,
+     * таблица из 2^rows произведений base^(2^(j * cols)) строится один раз, затем на каждую степень уходит cols
+     * возведений в квадрат и cols умножений вместо max_exp_bits квадратов. Запись таблицы выбирается
+     * mpn_sec_tabselect, умножение и приведение (mpn_sec_mul, mpn_sec_sqr, mpn_sec_div_r) выполняются на каждом
+     * шаге над числами фиксированной длины в лимбах модуля, поэтому, как и у mpz_powm_sec, от показателя зависит
+     * только его длина. После построения объект только читается и может использоваться из нескольких потоков
+     */
+    class FixedBasePow {
+        big_int _base;
+        big_int _mod;
+        size_t _max_exp_bits;
+        size_t _rows;
+        size_t _cols;
+        size_t _limbs;
+        std::vector<mp_limb_t> _table; // 2^rows записей по _limbs лимбов
+
+    public:
+        FixedBasePow(big_int base, big_int mod, size_t max_exp_bits, size_t rows = 6)
+            : _base(std::move(base)), _mod(std::move(mod)), _max_exp_bits(max_exp_bits), _rows(rows) {
+            if (_mod <= 1) {
+                throw std::invalid_argument("модуль должен быть больше 1");
+            }
+            if (max_exp_bits == 0 || rows == 0 || rows > 10) {
+                throw std::invalid_argument("некорректные параметры таблицы");
+            }
+            _cols = (max_exp_bits + rows - 1) / rows;
+            _limbs = mpz_size(_mod.backend().data());
+
+            // base^(2^(j * cols)) для каждой строки
+            std::vector<big_int> row_powers(rows);
+            row_powers[0] = _base % _mod;
+            if (row_powers[0] < 0) row_powers[0] += _mod;
+            for (size_t j = 1; j < rows; ++j) {
+                row_powers[j] = mod_pow(row_powers[j - 1], big_int(1) << _cols, _mod);
+            }
+
+            const size_t entries = size_t{1} << rows;
+            _table.assign(entries * _limbs, 0);
+            std::vector<big_int> products(entries);
+            products[0] = 1;
+            for (size_t i = 0; i < entries; ++i) {
+                if (i > 0) products[i] = products[i & (i - 1)] * row_powers[std::countr_zero(i)] % _mod;
+                const mpz_srcptr value = products[i].backend().data();
+                std::copy_n(mpz_limbs_read(value), mpz_size(value), _table.begin() + static_cast<ptrdiff_t>(i * _limbs));
+            }
+        }
+
+        [[nodiscard]] big_int pow(const big_int &exp) const {
+            if (exp < 0) {
+                throw std::invalid_argument("степень должна быть положительной");
+            }
+            if (exp != 0 && mp::msb(exp) >= _max_exp_bits) {
+                return (_mod & 1) ? mod_pow_sec(_base, exp, _mod) : mod_pow(_base, exp, _mod);
+            }
+            // остаток и выбранная запись всегда занимают _limbs лимбов, произведение - 2 * _limbs
+            const auto n = static_cast<mp_size_t>(_limbs);
+            const mp_limb_t *mod = mpz_limbs_read(_mod.backend().data());
+            const mpz_srcptr e = exp.backend().data();
+            std::vector<mp_limb_t> r(_limbs), entry(_limbs), product(2 * _limbs);
+            std::vector<mp_limb_t> scratch(std::max({
+                mpn_sec_sqr_itch(n), mpn_sec_mul_itch(n, n), mpn_sec_div_r_itch(2 * n, n)
+            }));
+            r[0] = 1;
+            for (auto col = static_cast<ptrdiff_t>(_cols) - 1; col >= 0; --col) {
+                mpn_sec_sqr(product.data(), r.data(), n, scratch.data());
+                mpn_sec_div_r(product.data(), 2 * n, mod, n, scratch.data());
+                std::copy_n(product.begin(), _limbs, r.begin());
+
+                mp_size_t index = 0;
+                for (size_t row = 0; row < _rows; ++row) {
+                    index |= static_cast<mp_size_t>(mpz_tstbit(e, row * _cols + static_cast<size_t>(col))) << row;
+                }
+                mpn_sec_tabselect(entry.data(), _table.data(), n, static_cast<mp_size_t>(size_t{1} << _rows), index);
+                mpn_sec_mul(product.data(), r.data(), n, entry.data(), n, scratch.data());
+                mpn_sec_div_r(product.data(), 2 * n, mod, n, scratch.data());
+                std::copy_n(product.begin(), _limbs, r.begin());
             }
-            a = (a * a) % mod;
-            pow >>= 1;
+            big_int res;
+            mpz_t view;
+            mpz_set(res.backend().data(), mpz_roinit_n(view, r.data(), n));
+            return res;
         }
+
+        [[nodiscard]] const big_int &get_base() const noexcept { return _base; }
+
+        [[nodiscard]] const big_int &get_modulus() const noexcept { return _mod; }
+
+        [[nodiscard]] size_t get_max_exp_bits() const noexcept { return _max_exp_bits; }
+    };
+
+    /**
+     * Перевод между big_int и байтами, младший байт первым. export_bytes дополняет нулями до out.size()
+     */
+    inline big_int import_bytes(std::span<const uint8_t> bytes) {
+        big_int res;
+        mpz_import(res.backend().data(), bytes.size(), -1, 1, 0, 0, bytes.data());
         return res;
     }
 
-    inline big_int gcd(const big_int &a, const big_int &b) {
-        big_int p1 = boost::multiprecision::abs(a);
-        big_int p2 = boost::multiprecision::abs(b);
-        while (p2 != 0) {
-            std::tie(p1, p2) = std::tuple(p2, big_int(p1 % p2));
+    inline void export_bytes(const big_int &value, std::span<uint8_t> out) {
+        if (value < 0 || (value != 0 && mp::msb(value) / 8 + 1 > out.size())) {
+            throw std::invalid_argument("value does not fit");
         }
-        return p1;
+        std::ranges::fill(out, 0);
+        size_t count = 0;
+        mpz_export(out.data(), &count, -1, 1, 0, 0, value.backend().data());
     }
 
-    /// @returns [gcd, x, y]
+    // НОД >= 0 (mpz_gcd)
+    inline big_int gcd(const big_int &a, const big_int &b) {
+        big_int res;
+        mpz_gcd(res.backend().data(), a.backend().data(), b.backend().data());
+        return res;
+    }
+
+    /// @returns [gcd, x, y]: a * x + n * y = gcd (mpz_gcdext, без рекурсии)
     inline std::tuple<big_int, big_int, big_int> egcd(const big_int &a, const big_int &n) {
-        if (a == 0) {
-            return {n, 0, 1};
+        big_int d, x, y;
+        mpz_gcdext(d.backend().data(), x.backend().data(), y.backend().data(), a.backend().data(),
+                   n.backend().data());
+        return {std::move(d), std::move(x), std::move(y)};
+    }
+
+    /**
+     * a^-1 mod m в [0, m) (mpz_invert), если gcd(a, m) != 1 - исключение
+     */
+    inline big_int mod_inverse(const big_int &a, const big_int &m) {
+        if (m <= 1) {
+            throw std::invalid_argument("модуль должен быть больше 1");
         }
-        auto [d, x1, y1] = egcd(n % a, a);
-        big_int x = y1 - (n / a) * x1;
-        big_int y = x1;
-        return {d, x, y};
+        big_int res;
+        if (mpz_invert(res.backend().data(), a.backend().data(), m.backend().data()) == 0) {
+            throw std::invalid_argument("элемент не обратим по модулю");
+        }
+        return res;
+    }
+
+    /**
+     * Варианты для остальных типов: бинарный НОД (только сдвиги и вычитания) и
+     * итеративный расширенный алгоритм Евклида для обратного
+     */
+    template<typename T>
+    T gcd(T a, T b) {
+        if (a < 0) a = -a;
+        if (b < 0) b = -b;
+        if (a == 0) return b;
+        if (b == 0) return a;
+        const auto shift = std::min(mp::lsb(a), mp::lsb(b));
+        a >>= mp::lsb(a);
+        while (b != 0) {
+            b >>= mp::lsb(b);
+            if (a > b) std::swap(a, b);
+            b -= a;
+        }
+        return a << shift;
     }
 
-    /// Source: http://www.uic.unn.ru/~zny/compalg/Lectures/ca_02_quadraticresidue.pdf
-    /// Source: https://ru.wikipedia.org/wiki/Символ_Якоби#Пример_вычисления
-    inline int jacobi_symbol(big_int a, big_int n) {
+    template<typename T>
+    T mod_inverse(const T &a, const T &m) {
+        if (m <= 1) {
+            throw std::invalid_argument("модуль должен быть больше 1");
+        }
+        // r_i = a * t_i (mod m)
+        T r0 = m, r1 = a % m;
+        if (r1 < 0) r1 += m;
+        T t0 = 0, t1 = 1;
+        while (r1 != 0) {
+            const T q = r0 / r1;
+            r0 -= q * r1;
+            std::swap(r0, r1);
+            t0 -= q * t1;
+            std::swap(t0, t1);
+        }
+        if (r0 != 1) {
+            throw std::invalid_argument("элемент не обратим по модулю");
+        }
+        return t0 < 0 ? T(t0 + m) : t0;
+    }
+
+    /**
+     * Символ Якоби (a / n) для нечётного n > 1 за один проход mpz_jacobi, 0 при gcd(a, n) != 1
+     */
+    inline int jacobi_symbol(const big_int &a, const big_int &n) {
         if (n < 2) {
             throw std::invalid_argument("p < 2");
         }
         if ((n & 1) == 0) {
             throw std::invalid_argument("n - чётное");
         }
-        if (gcd(a, n) != 1) { return 0; }
-        int r = 1;
-        if (a < 0) {
-            a = -a;
-            if (n % 4 == 3) { r *= -1; }
+        return mpz_jacobi(a.backend().data(), n.backend().data());
+    }
+
+    /**
+     * Бинарный алгоритм для остальных типов: двойки выносятся сдвигом, знак меняется по младшим битам n
+     * ((2 / n) = -1 при n = 3, 5 (mod 8), взаимность - при a = n = 3 (mod 4)). Без предварительного НОД:
+     * если gcd(a, n) != 1, цикл заканчивается на n != 1
+     */
+    template<typename T>
+    int jacobi_symbol(T a, T n) {
+        if (n < 2) {
+            throw std::invalid_argument("p < 2");
+        }
+        if ((n & 1) == 0) {
+            throw std::invalid_argument("n - чётное");
         }
+        const auto low_bits = [](const T &x) { return static_cast<unsigned>(x & 7); };
+        a %= n;
+        if (a < 0) a += n;
+        int r = 1;
         while (a != 0) {
-            size_t t = 0;
-            while ((a & 1) == 0) {
-                t++;
-                a >>= 1;
-            }
-            if ((t & 1) == 1) {
-                if (big_int mod8 = n % 8; mod8 == 3 || mod8 == 5) { r *= -1; }
-            }
-            if (a % 4 == 3 && n % 4 == 3) { r *= -1; }
-            std::tie(a, n) = std::tuple(big_int(n % a), a);
+            const auto twos = mp::lsb(a);
+            a >>= twos;
+            const unsigned n_mod8 = low_bits(n);
+            if ((twos & 1) && (n_mod8 == 3 || n_mod8 == 5)) r = -r;
+            if ((low_bits(a) & 3) == 3 && (n_mod8 & 3) == 3) r = -r;
+            std::swap(a, n);
+            a %= n;
         }
-        return r;
+        return n == 1 ? r : 0;
     }
 
     inline int legendre_symbol(const big_int &a, const big_int &p) {
@@ -1,13 +1,137 @@
 #ifndef _PRIMARY_TESTS_
 #define _PRIMARY_TESTS_
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <memory>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 #include <bits/random.h>
 #include <boost/random/uniform_int_distribution.hpp>
 #include <boost/random/mersenne_twister.hpp>
 #include "math.h"
+#include "worker_pool.h"
 
 namespace crypto::primary {
+    // Нечётные простые меньше 2^15 (решето Эратосфена, строится один раз)
+    inline const std::vector<uint32_t> &small_primes() {
+        static const std::vector<uint32_t> primes = [] {
+            constexpr uint32_t limit = 1 << 15;
+            std::vector<bool> composite(limit);
+            std::vector<uint32_t> res;
+            for (uint32_t i = 3; i < limit; i += 2) {
+                if (composite[i]) continue;
+                res.push_back(i);
+                for (uint64_t j = static_cast<uint64_t>(i) * i; j < limit; j += 2 * i) {
+                    composite[j] = true;
+                }
+            }
+            return res;
+        }();
+        return primes;
+    }
+
+    /**
+     * Перебор нечётных чисел start, start + 2, ... без малых простых делителей.
+     * Окно из WINDOW кандидатов просеивается по small_primes(); остатки start по модулю малых простых
+     * считаются один раз и при переходе к следующему окну сдвигаются на 2 * WINDOW
+     */
+    class IncrementalSieve {
+        big_int _base;
+        std::vector<uint32_t> _residues;
+        std::vector<bool> _composite;
+        size_t _pos{};
+
+    public:
+        static constexpr size_t WINDOW = 4096;
+
+        explicit IncrementalSieve(big_int start) : _base(std::move(start)), _composite(WINDOW) {
+            if ((_base & 1) == 0) ++_base;
+            const auto &primes = small_primes();
+            _residues.reserve(primes.size());
+            for (const auto prime: primes) {
+                _residues.push_back(static_cast<uint32_t>(mpz_fdiv_ui(_base.backend().data(), prime)));
+            }
+            sieve();
+        }
+
+        // Следующий кандидат, не делящийся ни на одно малое простое (кроме него самого)
+        big_int next() {
+            while (true) {
+                for (; _pos < WINDOW; ++_pos) {
+                    if (!_composite[_pos]) {
+                        return _base + 2 * _pos++;
+                    }
+                }
+                advance();
+            }
+        }
+
+    private:
+        void sieve() {
+            std::fill(_composite.begin(), _composite.end(), false);
+            const auto &primes = small_primes();
+            const bool small_base = _base <= primes.back();
+            for (size_t i = 0; i < primes.size(); ++i) {
+                const uint64_t prime = primes[i];
+                // base + 2k = 0 (mod p)  =>  k = (p - r) * 2^-1 (mod p), 2^-1 = (p + 1) / 2
+                uint64_t k = (prime - _residues[i]) % prime * ((prime + 1) / 2) % prime;
+                if (small_base && _base + 2 * k == prime) k += prime;
+                for (; k < WINDOW; k += prime) {
+                    _composite[k] = true;
+                }
+            }
+            _pos = 0;
+        }
+
+        void advance() {
+            _base += 2 * WINDOW;
+            const auto &primes = small_primes();
+            for (size_t i = 0; i < primes.size(); ++i) {
+                _residues[i] = static_cast<uint32_t>((_residues[i] + 2 * WINDOW) % primes[i]);
+            }
+            sieve();
+        }
+    };
+
+    /**
+     * Детерминированный тест Миллера-Рабина для n < 2^64 по основаниям {2, 325, 9375, 28178, 450775, 9780504,
+     * 1795265022} (набор Яешке-Синклера), умножение Монтгомери в машинных словах
+     */
+    inline bool is_prime_u64(uint64_t n) noexcept {
+        if (n < 2) return false;
+        for (const uint64_t p: {2u, 3u, 5u, 7u, 11u, 13u, 17u, 19u, 23u, 29u, 31u, 37u}) {
+            if (n % p == 0) return n == p;
+        }
+        if (n < 37 * 37) return true;
+
+        const math::detail::Montgomery64 mont(n);
+        const int s = std::countr_zero(n - 1);
+        const uint64_t d = (n - 1) >> s;
+        const uint64_t one = mont.to_form(1);
+        const uint64_t minus_one = mont.to_form(n - 1);
+        for (const uint64_t base: {2ull, 325ull, 9375ull, 28178ull, 450775ull, 9780504ull, 1795265022ull}) {
+            if (base % n == 0) continue;
+            uint64_t x = mont.pow(mont.to_form(base), d);
+            if (x == one || x == minus_one) continue;
+            bool witness = true;
+            for (int r = 1; r < s && witness; ++r) {
+                x = mont.mul(x, x);
+                witness = x != minus_one;
+            }
+            if (witness) return false;
+        }
+        return true;
+    }
+
+    // n < 2^64 проверяется детерминированно без big_int
+    inline bool fits_u64(const big_int &n) {
+        return n >= 0 && mp::msb(n | 1) < 64;
+    }
+
     class IProbabilisticPrimalityTest {
     public:
         // propability [0.5, 1)
@@ -31,20 +155,50 @@ namespace crypto::primary {
             if (probability < 0.5 || probability >= 1.) {
                 throw std::invalid_argument("probability not in [0.5; 1)");
             }
-            if (n == 2) return true;
+            return is_primary_rounds(n, round_count(probability));
+        }
+
+        /**
+         * Заданное число раундов: ошибка не больше coef^-rounds (64 раунда Миллера-Рабина - 2^-128, что в
+         * probability типа double не выразить). Первый раунд отсеивает почти все составные и идёт в вызывающем
+         * потоке, остальные при set_threads_count != 1 делятся между потоками пула теста, после первого
+         * найденного свидетеля оставшиеся раунды пропускаются
+         */
+        [[nodiscard]] bool is_primary_rounds(const big_int &n, const size_t rounds) const {
+            if (fits_u64(n)) return is_prime_u64(n.convert_to<uint64_t>());
             if (!(n & 1)) return false;
+            if (rounds == 0) return true;
+            if (!random_round(n)) return false;
 
-            const std::size_t rounds = round_count(probability);
+            if (!_pool || rounds <= 2) {
+                for (size_t cnt = 1; cnt < rounds; ++cnt) {
+                    if (!random_round(n)) return false;
+                }
+                return true;
+            }
+
+            std::atomic<bool> composite{false};
+            _pool->run(rounds - 1, [&](size_t) {
+                if (!composite.load(std::memory_order_relaxed) && !random_round(n)) composite = true;
+            });
+            return !composite;
+        }
+
+        // Потоки для раундов одной проверки: 1 - последовательно (по умолчанию), 0 - по числу ядер
+        void set_threads_count(size_t threads_count) {
+            _pool = threads_count == 1 ? nullptr : std::make_shared<WorkerPool>(threads_count);
+        }
+
+    private:
+        // общий для копий теста, run можно вызывать из нескольких потоков сразу
+        std::shared_ptr<WorkerPool> _pool;
+
+        [[nodiscard]] bool random_round(const big_int &n) const {
             namespace rnd = boost::random;
-            static rnd::mt19937_64 gen(static_cast<unsigned int>(std::time(nullptr)));
+            // свой генератор в каждом потоке: тест вызывается параллельно из PrimeSearch и is_primary_rounds
+            thread_local rnd::mt19937_64 gen(std::random_device{}());
             const rnd::uniform_int_distribution<big_int> dist(big_int(2), n - 1);
-
-            for (size_t cnt = 0; cnt < rounds; ++cnt) {
-                const big_int a = dist(gen);
-                if (a == n) return true;
-                if (!_is_primary(n, a)) return false;
-            }
-            return true;
+            return _is_primary(n, dist(gen));
         }
 
     protected:
@@ -71,13 +225,12 @@ namespace crypto::primary {
 
     class SolovayStrassenTest final : public ProbabilisticPrimalityTest {
         [[nodiscard]] bool _is_primary(const big_int &n, const big_int &a) const override {
-            if (math::gcd(a, n) == 1) {
-                int jacobi = math::jacobi_symbol(a, n);
-                big_int pow = math::mod_pow(a, big_int((n - 1) / 2), n);
-                if (jacobi == -1) return pow == n - 1;
-                return pow == jacobi;
-            }
-            return false;
+            // (a / n) = 0 при gcd(a, n) != 1 - отдельный НОД не нужен
+            const int jacobi = math::jacobi_symbol(a, n);
+            if (jacobi == 0) return false;
+            big_int pow = math::mod_pow(a, big_int((n - 1) / 2), n);
+            if (jacobi == -1) return pow == n - 1;
+            return pow == jacobi;
         }
     };
 
@@ -97,7 +250,7 @@ namespace crypto::primary {
                 if (x == n - 1) {
                     return true;
                 }
-                x = math::mod_pow(x, big_int(2), n);
+                x = x * x % n;
             }
             return false;
         }
@@ -105,6 +258,112 @@ namespace crypto::primary {
     public:
         MillerRabinTest() : ProbabilisticPrimalityTest(4) {}
     };
+
+    /**
+     * Baillie-PSW: пробное деление на малые простые, сильный тест Ферма по основанию 2 и сильный тест Люка
+     * с параметрами Селфриджа. Псевдопростых не известно, поэтому probability не влияет на число раундов.
+     * n < 2^64 проверяются через is_prime_u64
+     */
+    class BailliePSWTest final : public IProbabilisticPrimalityTest {
+        static constexpr uint32_t TRIAL_LIMIT = 1024;
+
+    public:
+        [[nodiscard]] bool is_primary(const big_int &n, const double probability) const override {
+            if (probability < 0.5 || probability >= 1.) {
+                throw std::invalid_argument("probability not in [0.5; 1)");
+            }
+            if (fits_u64(n)) return is_prime_u64(n.convert_to<uint64_t>());
+            if (!(n & 1)) return false;
+
+            for (const auto prime: small_primes()) {
+                if (prime >= TRIAL_LIMIT) break;
+                if (mpz_fdiv_ui(n.backend().data(), prime) == 0) return false;
+            }
+
+            return strong_probable_prime(n, 2) && strong_lucas_probable_prime(n);
+        }
+
+        // Сильный тест Ферма: n - 1 = d * 2^s, a^d = 1 или a^(d * 2^r) = -1 (mod n) для некоторого r < s
+        [[nodiscard]] static bool strong_probable_prime(const big_int &n, const big_int &a) {
+            const big_int n_minus_one = n - 1;
+            const size_t s = mp::lsb(n_minus_one);
+            big_int x = math::mod_pow(a, big_int(n_minus_one >> s), n);
+            if (x == 1 || x == n_minus_one) return true;
+            for (size_t r = 1; r < s; ++r) {
+                x = x * x % n;
+                if (x == n_minus_one) return true;
+            }
+            return false;
+        }
+
+        /**
+         * Сильный тест Люка для нечётного n > 2, D - первое из 5, -7, 9, -11, ... с (D / n) = -1, P = 1, Q = (1 - D) / 4.
+         * n + 1 = d * 2^s: U_d = 0 или V_(d * 2^r) = 0 (mod n) для некоторого r < s
+         */
+        [[nodiscard]] static bool strong_lucas_probable_prime(const big_int &n) {
+            const big_int root = mp::sqrt(n);
+            if (root * root == n) return false; // у квадрата нет D с (D / n) = -1
+
+            long d_param = 5;
+            while (true) {
+                const int jacobi = math::jacobi_symbol(big_int(d_param), n);
+                if (jacobi == -1) break;
+                if (jacobi == 0 && n != std::abs(d_param)) return false;
+                d_param = d_param > 0 ? -(d_param + 2) : -d_param + 2;
+            }
+            const long q_param = (1 - d_param) / 4;
+
+            const big_int n_plus_one = n + 1;
+            const size_t s = mp::lsb(n_plus_one);
+            const big_int d = n_plus_one >> s;
+
+            // Цикл на mpz_* без временных объектов: на 1024 битах выражения boost заметно медленнее
+            const mpz_srcptr mod = n.backend().data();
+            big_int u_val = 1, v_val = 1, q_val = q_param, tmp_val;
+            mpz_ptr u = u_val.backend().data(), v = v_val.backend().data();
+            mpz_ptr q_k = q_val.backend().data(), tmp = tmp_val.backend().data();
+            mpz_mod(q_k, q_k, mod);
+            // (x + t) / 2 mod n для x, t из [0, n)
+            auto half_sum = [mod](mpz_ptr x, mpz_srcptr t) {
+                mpz_add(x, x, t);
+                if (mpz_odd_p(x)) mpz_add(x, x, mod);
+                mpz_fdiv_q_2exp(x, x, 1);
+                if (mpz_cmp(x, mod) >= 0) mpz_sub(x, x, mod);
+            };
+
+            // U_1 = 1, V_1 = P = 1, Q^1; слева направо: k -> 2k (-> 2k + 1)
+            for (auto bit = static_cast<ptrdiff_t>(mp::msb(d)) - 1; bit >= 0; --bit) {
+                mpz_mul(u, u, v);
+                mpz_mod(u, u, mod);
+                mpz_mul(v, v, v);
+                mpz_submul_ui(v, q_k, 2);
+                mpz_mod(v, v, mod);
+                mpz_mul(q_k, q_k, q_k);
+                mpz_mod(q_k, q_k, mod);
+                if (mp::bit_test(d, bit)) {
+                    // U' = (U + V) / 2, V' = (D * U + V) / 2
+                    mpz_mul_si(tmp, u, d_param);
+                    mpz_mod(tmp, tmp, mod);
+                    half_sum(u, v);
+                    half_sum(v, tmp);
+                    mpz_mul_si(q_k, q_k, q_param);
+                    mpz_mod(q_k, q_k, mod);
+                }
+            }
+            auto is_zero = [](mpz_srcptr x) { return mpz_sgn(x) == 0; };
+            if (is_zero(u) || is_zero(v)) return true;
+            for (size_t r = 1; r < s; ++r) {
+                mpz_mul(v, v, v);
+                mpz_submul_ui(v, q_k, 2);
+                mpz_mod(v, v, mod);
+                if (is_zero(v)) return true;
+                mpz_mul(q_k, q_k, q_k);
+                mpz_mod(q_k, q_k, mod);
+            }
+            return false;
+        }
+    };
+
 } // namespace meow::primary
 
 #endif // _PRIMARY_TESTS_
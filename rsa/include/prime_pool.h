@@ -0,0 +1,104 @@
+#ifndef _PRIME_POOL_
+#define _PRIME_POOL_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include "prime_search.h"
+
+namespace crypto::primary {
+    /**
+     * Очередь готовых простых из [low, high] глубиной до depth. Фоновый поток дополняет её,
+     * делая паузу refill_pause после каждого найденного простого; pop() берёт простое из очереди,
+     * а если она пуста - ищет его сам в вызывающем потоке
+     */
+    class PrimePool {
+    public:
+        struct Stats {
+            uint64_t hits{}; // pop() из очереди
+            uint64_t misses{}; // pop() с поиском в вызывающем потоке
+            uint64_t produced{}; // найдено фоновым потоком
+            size_t ready{}; // сейчас в очереди
+            size_t depth{};
+        };
+
+    private:
+        big_int _low, _high;
+        PrimeSearch::Predicate _is_prime;
+        PrimeSearch _search;
+        size_t _depth;
+        std::chrono::milliseconds _refill_pause;
+
+        mutable std::mutex _mutex;
+        std::condition_variable_any _cv;
+        std::deque<big_int> _primes;
+        Stats _stats;
+        // последний член: разрушается первым, останавливая и дожидаясь фоновый поиск
+        std::jthread _worker;
+
+    public:
+        PrimePool(big_int low, big_int high, PrimeSearch::Predicate is_prime, size_t depth,
+                  std::chrono::milliseconds refill_pause = {}, size_t search_threads = 1)
+            : _low(std::move(low)), _high(std::move(high)), _is_prime(std::move(is_prime)),
+              _search(search_threads), _depth(depth), _refill_pause(refill_pause) {
+            if (depth == 0)
+                throw std::invalid_argument("pool depth must be positive");
+            _stats.depth = depth;
+            _worker = std::jthread([this](const std::stop_token &stop) { refill(stop); });
+        }
+
+        PrimePool(const PrimePool &) = delete;
+
+        PrimePool &operator=(const PrimePool &) = delete;
+
+        [[nodiscard]] big_int pop() {
+            {
+                std::lock_guard lock(_mutex);
+                if (!_primes.empty()) {
+                    big_int prime = std::move(_primes.front());
+                    _primes.pop_front();
+                    ++_stats.hits;
+                    _cv.notify_all();
+                    return prime;
+                }
+                ++_stats.misses;
+            }
+            return _search.find(_low, _high, _is_prime);
+        }
+
+        [[nodiscard]] Stats stats() const {
+            std::lock_guard lock(_mutex);
+            Stats res = _stats;
+            res.ready = _primes.size();
+            return res;
+        }
+
+    private:
+        void refill(const std::stop_token &stop) {
+            while (true) {
+                {
+                    std::unique_lock lock(_mutex);
+                    if (!_cv.wait(lock, stop, [this] { return _primes.size() < _depth; }))
+                        return;
+                }
+                auto prime = _search.find(_low, _high, _is_prime, stop);
+                if (!prime)
+                    return;
+                {
+                    std::unique_lock lock(_mutex);
+                    _primes.push_back(std::move(*prime));
+                    ++_stats.produced;
+                    if (_refill_pause.count() > 0)
+                        _cv.wait_for(lock, stop, _refill_pause, [] { return false; });
+                }
+            }
+        }
+    };
+}
+
+#endif //_PRIME_POOL_
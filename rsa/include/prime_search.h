@@ -0,0 +1,106 @@
+#ifndef _PRIME_SEARCH_
+#define _PRIME_SEARCH_
+
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <vector>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include "primary_tests.h"
+
+namespace crypto::primary {
+    /**
+     * Параллельный поиск простого в отрезке [low, high].
+     * Отрезок делится на непересекающиеся части по числу потоков, каждый поток со своим генератором выбирает
+     * случайную точку в своей части и идёт вверх по IncrementalSieve до выхода за её границу.
+     * Первый нашедший простое останавливает остальных через std::stop_token
+     */
+    class PrimeSearch {
+        size_t _threads_count;
+
+    public:
+        using Predicate = std::function<bool(const big_int &)>;
+
+        // 0 - по числу ядер
+        explicit PrimeSearch(size_t threads_count = 0)
+            : _threads_count(threads_count ? threads_count : std::max(1u, std::thread::hardware_concurrency())) {}
+
+        [[nodiscard]] size_t get_threads_count() const noexcept {
+            return _threads_count;
+        }
+
+        // is_prime вызывается одновременно из нескольких потоков
+        [[nodiscard]] big_int find(const big_int &low, const big_int &high, const Predicate &is_prime) const {
+            return *find(low, high, is_prime, {});
+        }
+
+        // Поиск, прерываемый извне: nullopt, если cancel сработал раньше, чем нашлось простое
+        [[nodiscard]] std::optional<big_int> find(const big_int &low, const big_int &high, const Predicate &is_prime,
+                                                  const std::stop_token &cancel) const {
+            if (low > high)
+                throw std::invalid_argument("empty search range");
+
+            const big_int width = (high - low + 1) / _threads_count;
+            const size_t threads = width > 0 ? _threads_count : 1;
+            std::vector<unsigned int> seeds(threads);
+            std::random_device rd;
+            for (auto &seed: seeds) seed = rd();
+
+            if (threads == 1)
+                return search(low, high, is_prime, seeds[0], cancel);
+
+            std::stop_source stop;
+            std::stop_callback forward(cancel, [&stop] { stop.request_stop(); });
+            std::mutex mutex;
+            std::optional<big_int> result;
+            std::exception_ptr error;
+            {
+                std::vector<std::jthread> workers;
+                workers.reserve(threads);
+                for (size_t i = 0; i < threads; ++i) {
+                    big_int part_low = low + width * i;
+                    big_int part_high = i + 1 == threads ? high : big_int(part_low + width - 1);
+                    workers.emplace_back([&, part_low = std::move(part_low), part_high = std::move(part_high),
+                                             seed = seeds[i]] {
+                        try {
+                            auto found = search(part_low, part_high, is_prime, seed, stop.get_token());
+                            if (!found) return;
+                            std::lock_guard lock(mutex);
+                            if (!result) result = std::move(found);
+                        }
+                        catch (...) {
+                            std::lock_guard lock(mutex);
+                            if (!error) error = std::current_exception();
+                        }
+                        stop.request_stop();
+                    });
+                }
+            }
+            if (error) std::rethrow_exception(error);
+            return result;
+        }
+
+    private:
+        static std::optional<big_int> search(const big_int &low, const big_int &high, const Predicate &is_prime,
+                                             unsigned int seed, const std::stop_token &stop) {
+            boost::random::mt19937 gen(seed);
+            const boost::random::uniform_int_distribution<big_int> dist(low, high);
+            while (!stop.stop_requested()) {
+                IncrementalSieve sieve(dist(gen));
+                for (big_int candidate = sieve.next(); candidate <= high; candidate = sieve.next()) {
+                    if (stop.stop_requested()) return std::nullopt;
+                    if (is_prime(candidate)) return candidate;
+                }
+            }
+            return std::nullopt;
+        }
+    };
+}
+
+#endif //_PRIME_SEARCH_
@@ -1,11 +1,17 @@
 #ifndef _RSA_H_
 #define _RSA_H_
 
+#include <chrono>
 #include <future>
 #include <filesystem>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <span>
 #include <vector>
 #include "math.h"
+#include "prime_pool.h"
+#include "worker_pool.h"
 
 namespace crypto::rsa {
     class RSACryptoService final {
@@ -14,6 +20,7 @@ namespace crypto::rsa {
             FERMAT,
             SOLOVAY_STRASSEN,
             MILLER_RABIN,
+            BAILLIE_PSW,
         };
 
         struct KeyRSA {
@@ -21,6 +28,25 @@ namespace crypto::rsa {
             big_int modulus;
         };
 
+        // Параметры закрытого ключа для расшифрования по китайской теореме об остатках
+        struct CRTParams {
+            big_int p, q;
+            big_int dP, dQ; // d mod (p - 1), d mod (q - 1)
+            big_int qInv; // q^-1 mod p
+
+            // Остальные простые многопростого ключа (RFC 8017): r, d mod (r - 1), (p * q * ...)^-1 mod r
+            struct ExtraPrime {
+                big_int r, d, t;
+            };
+
+            std::vector<ExtraPrime> others;
+
+            [[nodiscard]] static CRTParams from_primes(const big_int &p, const big_int &q, const big_int &d);
+
+            // primes[0] - p, primes[1] - q, остальные попадают в others
+            [[nodiscard]] static CRTParams from_primes(std::span<const big_int> primes, const big_int &d);
+        };
+
         RSACryptoService(RSACryptoService &) = delete;
 
         RSACryptoService(RSACryptoService &&) = default;
@@ -37,29 +63,61 @@ namespace crypto::rsa {
             struct KeyPairRSA {
                 KeyRSA publicKey;
                 KeyRSA privateKey;
+                std::optional<CRTParams> crt;
             };
 
             [[nodiscard]] KeyPairRSA generate_key_pair() const;
 
             [[nodiscard]] KeyPairRSA generate_weak_key_pair() const;
 
+            void set_threads_count(size_t threads_count) {
+                _threads_count = threads_count;
+            }
+
+            void set_primes_count(size_t primes_count);
+
+            void enable_prime_pool(size_t depth, std::chrono::milliseconds refill_pause);
+
+            void disable_prime_pool();
+
+            [[nodiscard]] std::optional<std::pair<primary::PrimePool::Stats, primary::PrimePool::Stats> >
+            get_prime_pool_stats() const;
+
         private:
             PrimalityTestType _test_type;
             double _min_probability;
             size_t _prime_bit_len;
+            size_t _threads_count{0};
+            size_t _primes_count{2};
+            std::unique_ptr<primary::PrimePool> _p_pool, _q_pool;
 
             [[nodiscard]] std::pair<big_int, big_int> generate_prime_pair() const;
 
-            [[nodiscard]] big_int generate_prime_candidate() const;
+            // Простые модуля: пара p, q или _primes_count простых с суммарной длиной 2 * _prime_bit_len
+            [[nodiscard]] std::vector<big_int> generate_primes() const;
+
+            [[nodiscard]] primary::PrimeSearch::Predicate prime_predicate() const;
+
+            // Диапазон p (upper) или q: старшие 8 бит p установлены, следующие за старшим 8 бит q сброшены
+            [[nodiscard]] std::pair<big_int, big_int> prime_range(bool upper) const;
         };
 
     public:
         RSACryptoService(PrimalityTestType test_type, double min_probability, size_t prime_bit_len);
 
+        // Простые проверяются тестом Baillie-PSW
+        explicit RSACryptoService(size_t prime_bit_len);
+
         [[nodiscard]] big_int encrypt(const big_int &data) const;
 
         [[nodiscard]] big_int decrypt(const big_int &data) const;
 
+        /**
+         * Расшифрование пачки независимых шифротекстов одним ключом: CRT-параметры общие, пачка делится между
+         * постоянными потоками сервиса (set_threads_count), результаты в исходном порядке
+         */
+        [[nodiscard]] std::vector<big_int> decrypt(std::span<const big_int> data) const;
+
         [[nodiscard]] std::future<void> encrypt(const std::filesystem::path &in_path,
                                                 const std::filesystem::path &out_path) const;
 
@@ -76,9 +134,78 @@ namespace crypto::rsa {
 
         void set_public_key(KeyRSA pub_key);
 
+        // Закрытый ключ без параметров CRT расшифровывается полным возведением в степень по модулю N
+        void set_private_key(KeyRSA priv_key, std::optional<CRTParams> crt = std::nullopt);
+
+        [[nodiscard]] const std::optional<CRTParams> &get_crt_params() const {
+            return _key_pair.crt;
+        }
+
+        // Две половинные экспоненты CRT в отдельных потоках
+        void set_parallel_crt(bool parallel) {
+            _parallel_crt = parallel;
+        }
+
+        /**
+         * Число потоков для шифрования файлов, пакетного расшифрования и поиска простых, 0 - по числу ядер.
+         * Файлы и пачки обрабатываются пулом потоков сервиса, который здесь создаётся заново
+         */
+        void set_threads_count(size_t threads_count) {
+            _pool = std::make_shared<WorkerPool>(threads_count);
+            _key_generator->set_threads_count(threads_count);
+        }
+
+        /**
+         * Число простых в модуле следующих ключей: 2 (по умолчанию), 3 или 4 простых примерно равной длины,
+         * длина модуля - 2 * prime_bit_len бит. Расшифрование по CRT - по всем простым
+         */
+        void set_primes_count(size_t primes_count) {
+            _key_generator->set_primes_count(primes_count);
+        }
+
+        /**
+         * Пул готовых простых для generate_key_pair: по depth простых для p и q, фоновый поток дополняет пул
+         * с паузой refill_pause после каждого простого. Если пул пуст, простое ищется как обычно.
+         * Используется только для ключей из двух простых
+         */
+        void enable_prime_pool(size_t depth, std::chrono::milliseconds refill_pause = {}) {
+            _key_generator->enable_prime_pool(depth, refill_pause);
+        }
+
+        void disable_prime_pool() {
+            _key_generator->disable_prime_pool();
+        }
+
+        // Счётчики пулов для p и q, nullopt - пул выключен
+        [[nodiscard]] std::optional<std::pair<primary::PrimePool::Stats, primary::PrimePool::Stats> >
+        get_prime_pool_stats() const {
+            return _key_generator->get_prime_pool_stats();
+        }
+
     private:
         std::unique_ptr<RSAKeyGenerator> _key_generator;
         RSAKeyGenerator::KeyPairRSA _key_pair;
+        bool _parallel_crt{false};
+        // разделяется с ещё не завершёнными файловыми операциями
+        std::shared_ptr<WorkerPool> _pool;
+
+        static constexpr size_t _blocks_per_thread = 16;
+
+        [[nodiscard]] static big_int decrypt_value(const big_int &data, const KeyRSA &key,
+                                                   const std::optional<CRTParams> &crt, bool parallel);
+
+        // Размер блока открытого текста и шифротекста в байтах
+        [[nodiscard]] static std::pair<size_t, size_t> block_sizes(const big_int &modulus);
+
+        static void write_u64(std::ostream &out, uint64_t value);
+
+        [[nodiscard]] static uint64_t read_u64(std::istream &in);
+
+        static void parallel_for(WorkerPool &pool, size_t count, const std::function<void(size_t, size_t)> &work);
+
+        static void process_blocks(std::istream &in, std::ostream &out, uint64_t blocks_count,
+                                   size_t in_block, size_t out_block, uint64_t out_length, WorkerPool &pool,
+                                   const std::function<big_int(const big_int &)> &transform);
 
         void generate_weak_key_pair();
 
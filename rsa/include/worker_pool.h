@@ -0,0 +1,103 @@
+#ifndef _WORKER_POOL_
+#define _WORKER_POOL_
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace crypto {
+    /**
+     * Постоянные потоки для коротких параллельных задач: run(count, task) выполняет task(0..count-1)
+     * силами пула и вызывающего потока и возвращается, когда выполнены все. Несколько run из разных
+     * потоков (и из самих задач) обслуживаются одновременно. Первое исключение задачи перебрасывается из run,
+     * оставшиеся задачи этого вызова пропускаются
+     */
+    class WorkerPool {
+        struct Job {
+            const std::function<void(size_t)> &task;
+            size_t count{};
+            size_t next{}; // следующая невыданная задача
+            size_t finished{};
+            std::exception_ptr error{};
+        };
+
+        size_t _threads_count;
+
+        std::mutex _mutex;
+        std::condition_variable_any _has_jobs;
+        std::condition_variable _job_done;
+        std::deque<Job *> _jobs; // вызовы run, у которых остались невыданные задачи
+        // последний член: разрушается первым, останавливая и дожидаясь потоки
+        std::vector<std::jthread> _workers;
+
+    public:
+        // Всего потоков вместе с вызывающим, 0 - по числу ядер
+        explicit WorkerPool(size_t threads_count = 0)
+            : _threads_count(threads_count ? threads_count : std::max(1u, std::thread::hardware_concurrency())) {
+            _workers.reserve(_threads_count - 1);
+            for (size_t i = 1; i < _threads_count; ++i) {
+                _workers.emplace_back([this](const std::stop_token &stop) { work(stop); });
+            }
+        }
+
+        WorkerPool(const WorkerPool &) = delete;
+
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        [[nodiscard]] size_t get_threads_count() const noexcept {
+            return _threads_count;
+        }
+
+        void run(size_t count, const std::function<void(size_t)> &task) {
+            if (count == 0) return;
+            Job job{.task = task, .count = count};
+            std::unique_lock lock(_mutex);
+            if (!_workers.empty()) {
+                _jobs.push_back(&job);
+                _has_jobs.notify_all();
+            }
+            while (job.next < job.count) {
+                execute(job, lock);
+            }
+            _job_done.wait(lock, [&job] { return job.finished == job.count; });
+            if (job.error) std::rethrow_exception(job.error);
+        }
+
+    private:
+        void work(const std::stop_token &stop) {
+            std::unique_lock lock(_mutex);
+            while (_has_jobs.wait(lock, stop, [this] { return !_jobs.empty(); })) {
+                execute(*_jobs.front(), lock);
+            }
+        }
+
+        // Берёт очередную задачу job и выполняет её без блокировки
+        void execute(Job &job, std::unique_lock<std::mutex> &lock) {
+            const size_t index = job.next++;
+            if (job.next == job.count) {
+                if (const auto it = std::ranges::find(_jobs, &job); it != _jobs.end()) _jobs.erase(it);
+            }
+            if (!job.error) {
+                lock.unlock();
+                std::exception_ptr error;
+                try {
+                    job.task(index);
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
+                lock.lock();
+                if (error && !job.error) job.error = error;
+            }
+            if (++job.finished == job.count) _job_done.notify_all();
+        }
+    };
+}
+
+#endif //_WORKER_POOL_
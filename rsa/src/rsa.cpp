@@ -1,9 +1,14 @@
 #include "rsa.h"
 
+#include <algorithm>
 #include <bitset>
 #include <fstream>
 #include <future>
+#include <limits>
+#include <random>
+#include <thread>
 
+#include "prime_search.h"
 #include "primary_tests.h"
 #include <boost/random/uniform_int_distribution.hpp>
 #include <boost/random/mersenne_twister.hpp>
@@ -14,7 +19,11 @@ namespace crypto::rsa {
     RSACryptoService::RSACryptoService(PrimalityTestType test_type,
                                        double min_probability,
                                        size_t bit_len)
-        : _key_generator(std::make_unique<RSAKeyGenerator>(test_type, min_probability, bit_len)) {}
+        : _key_generator(std::make_unique<RSAKeyGenerator>(test_type, min_probability, bit_len)),
+          _pool(std::make_shared<WorkerPool>()) {}
+
+    RSACryptoService::RSACryptoService(size_t bit_len)
+        : RSACryptoService(PrimalityTestType::BAILLIE_PSW, 0.999, bit_len) {}
 
     big_int RSACryptoService::encrypt(const big_int &data) const {
         if (data >= _key_pair.publicKey.modulus)
@@ -29,9 +38,90 @@ namespace crypto::rsa {
     big_int RSACryptoService::decrypt(const big_int &data) const {
         if (data >= _key_pair.privateKey.modulus)
             throw std::invalid_argument("data >= mod");
-        return math::mod_pow(data, _key_pair.privateKey.exponent, _key_pair.privateKey.modulus);
+        return decrypt_value(data, _key_pair.privateKey, _key_pair.crt, _parallel_crt);
+    }
+
+    std::vector<big_int> RSACryptoService::decrypt(std::span<const big_int> data) const {
+        const auto &key = _key_pair.privateKey;
+        if (std::ranges::any_of(data, [&key](const big_int &value) { return value >= key.modulus; }))
+            throw std::invalid_argument("data >= mod");
+
+        std::vector<big_int> res(data.size());
+        parallel_for(*_pool, data.size(), [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                res[i] = decrypt_value(data[i], key, _key_pair.crt, false);
+            }
+        });
+        return res;
+    }
+
+    RSACryptoService::CRTParams RSACryptoService::CRTParams::from_primes(const big_int &p, const big_int &q,
+                                                                         const big_int &d) {
+        return {p, q, d % (p - 1), d % (q - 1), math::mod_inverse(q, p), {}};
     }
 
+    RSACryptoService::CRTParams RSACryptoService::CRTParams::from_primes(std::span<const big_int> primes,
+                                                                         const big_int &d) {
+        if (primes.size() < 2)
+            throw std::invalid_argument("at least two primes required");
+        CRTParams res = from_primes(primes[0], primes[1], d);
+        big_int product = primes[0] * primes[1];
+        for (const auto &r: primes.subspan(2)) {
+            res.others.push_back({r, d % (r - 1), math::mod_inverse(product, r)});
+            product *= r;
+        }
+        return res;
+    }
+
+    /*
+     * m1 = c^dP mod p, m2 = c^dQ mod q, m = m2 + q * (qInv * (m1 - m2) mod p).
+     * Для остальных простых (Гарнер): m_i = c^d_i mod r_i, m += R * ((m_i - m) * t_i mod r_i), R = p * q * ... * r_(i-1)
+     */
+    big_int RSACryptoService::decrypt_value(const big_int &data, const KeyRSA &key,
+                                            const std::optional<CRTParams> &crt, bool parallel) {
+        if (!crt)
+            return math::mod_pow_sec(data, key.exponent, key.modulus);
+
+        auto half = [&data](const big_int &exp, const big_int &prime) {
+            return math::mod_pow_sec(big_int(data % prime), exp, prime);
+        };
+        big_int m1, m2;
+        std::vector<big_int> extra(crt->others.size());
+        if (parallel) {
+            auto m1_fut = std::async(std::launch::async, half, std::cref(crt->dP), std::cref(crt->p));
+            std::vector<std::future<big_int> > extra_fut;
+            for (const auto &other: crt->others) {
+                extra_fut.push_back(std::async(std::launch::async, half, std::cref(other.d), std::cref(other.r)));
+            }
+            m2 = half(crt->dQ, crt->q);
+            m1 = m1_fut.get();
+            for (size_t i = 0; i < extra.size(); ++i) extra[i] = extra_fut[i].get();
+        }
+        else {
+            m1 = half(crt->dP, crt->p);
+            m2 = half(crt->dQ, crt->q);
+            for (size_t i = 0; i < extra.size(); ++i) extra[i] = half(crt->others[i].d, crt->others[i].r);
+        }
+        big_int h = (crt->qInv * (m1 - m2)) % crt->p;
+        if (h < 0) h += crt->p;
+        big_int m = m2 + h * crt->q;
+
+        big_int product = crt->p * crt->q;
+        for (size_t i = 0; i < extra.size(); ++i) {
+            const auto &other = crt->others[i];
+            h = ((extra[i] - m) * other.t) % other.r;
+            if (h < 0) h += other.r;
+            m += product * h;
+            if (i + 1 < extra.size()) product *= other.r;
+        }
+        return m;
+    }
+
+    /*
+     * Формат файла: 8 байт - длина открытого текста (little-endian), затем блоки шифротекста по
+     * ceil(bits / 8) байт. Блок открытого текста - floor((bits - 1) / 8) байт, поэтому всегда меньше
+     * модуля; последний блок дополняется нулями
+     */
     std::future<void> RSACryptoService::encrypt(const std::filesystem::path &in_path,
                                                 const std::filesystem::path &out_path) const {
         std::ifstream in(in_path, std::ios::binary);
@@ -42,26 +132,17 @@ namespace crypto::rsa {
         if (!out.is_open())
             throw std::invalid_argument("failed to open output file");
 
-        auto task = [key = get_public_key(), in = std::move(in), out = std::move(out)]() mutable {
-            auto buf_size = (mp::msb(key.modulus) + 1) / 8;
-            std::vector<uint8_t> buf(buf_size);
-
-            while (in.read(reinterpret_cast<char *>(buf.data()), buf_size)) {
-                mp::cpp_int chunk_value;
-                mp::import_bits(chunk_value, buf.begin(), buf.end(), 8, false);
-                auto res = math::mod_pow(chunk_value, key.exponent, key.modulus);
-                std::vector<uint8_t> out_buf(buf_size, 0);
-                mp::export_bits(res, out_buf.begin(), 8, false);
-                out.write(reinterpret_cast<const char *>(out_buf.data()), buf_size);
-            }
-            size_t bytes_read = in.gcount();
-            buf.back() = buf_size - bytes_read;
-            mp::cpp_int chunk_value;
-            mp::import_bits(chunk_value, buf.begin(), buf.end(), 8, false);
-            auto res = math::mod_pow(chunk_value, key.exponent, key.modulus);
-            std::vector<uint8_t> out_buf(buf_size, 0);
-            mp::export_bits(res, out_buf.begin(), 8, false);
-            out.write(reinterpret_cast<const char *>(out_buf.data()), buf_size);
+        auto task = [key = get_public_key(), pool = _pool, in_path,
+                    in = std::move(in), out = std::move(out)]() mutable {
+            const auto [plain_size, cipher_size] = block_sizes(key.modulus);
+            const uint64_t file_size = std::filesystem::file_size(in_path);
+            write_u64(out, file_size);
+
+            const auto transform = [&key](const big_int &value) {
+                return math::mod_pow(value, key.exponent, key.modulus);
+            };
+            process_blocks(in, out, (file_size + plain_size - 1) / plain_size, plain_size, cipher_size,
+                           std::numeric_limits<uint64_t>::max(), *pool, transform);
         };
         return std::async(std::launch::async, std::move(task));
     }
@@ -76,38 +157,92 @@ namespace crypto::rsa {
         if (!out.is_open())
             throw std::invalid_argument("failed to open output file");
 
-        auto task = [key = get_priv_key(), in = std::move(in), out = std::move(out)]() mutable {
-            auto buf_size = (mp::msb(key.modulus) + 1) / 8;
-            std::vector<uint8_t> buf(buf_size);
+        auto task = [key = get_priv_key(), crt = _key_pair.crt, parallel = _parallel_crt, pool = _pool,
+                    in_path, in = std::move(in), out = std::move(out)]() mutable {
+            const auto [plain_size, cipher_size] = block_sizes(key.modulus);
+            const uint64_t file_size = std::filesystem::file_size(in_path);
+            const uint64_t plain_length = read_u64(in);
+            const uint64_t blocks_count = (plain_length + plain_size - 1) / plain_size;
+            if (!in || file_size != 8 + blocks_count * cipher_size)
+                throw std::runtime_error("corrupted encrypted file");
+
+            const auto transform = [&key, &crt, parallel](const big_int &value) {
+                if (value >= key.modulus)
+                    throw std::runtime_error("corrupted encrypted file");
+                return decrypt_value(value, key, crt, parallel);
+            };
+            process_blocks(in, out, blocks_count, cipher_size, plain_size, plain_length, *pool, transform);
+        };
+        return std::async(std::launch::async, std::move(task));
+    }
 
-            in.seekg(0, std::ios::end);
-            size_t file_size = in.tellg();
-            in.seekg(0);
-            size_t cur_size = 0;
+    std::pair<size_t, size_t> RSACryptoService::block_sizes(const big_int &modulus) {
+        const size_t bits = mp::msb(modulus) + 1;
+        if (bits <= 8)
+            throw std::invalid_argument("modulus is too small");
+        return {(bits - 1) / 8, (bits + 7) / 8};
+    }
 
-            while (in.read(reinterpret_cast<char *>(buf.data()), buf_size)) {
-                cur_size += in.gcount();
-                if (cur_size == file_size) break;
-                mp::cpp_int encrypted_value;
-                mp::import_bits(encrypted_value, buf.begin(), buf.end(), 8, false);
+    void RSACryptoService::write_u64(std::ostream &out, uint64_t value) {
+        std::array<uint8_t, 8> bytes{};
+        for (size_t i = 0; i < bytes.size(); ++i) {
+            bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+        out.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    }
 
-                auto decrypted = math::mod_pow(encrypted_value, key.exponent, key.modulus);
+    uint64_t RSACryptoService::read_u64(std::istream &in) {
+        std::array<uint8_t, 8> bytes{};
+        in.read(reinterpret_cast<char *>(bytes.data()), bytes.size());
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes.size(); ++i) {
+            value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+        }
+        return value;
+    }
 
-                std::vector<uint8_t> out_buf(buf_size, 0);
-                mp::export_bits(decrypted, out_buf.begin(), 8, false);
+    // [0, count) делится на непрерывные части по числу потоков пула, одна из них - в вызывающем потоке
+    void RSACryptoService::parallel_for(WorkerPool &pool, size_t count,
+                                        const std::function<void(size_t, size_t)> &work) {
+        if (count == 0) return;
+        const size_t parts = std::min(pool.get_threads_count(), count);
+        const size_t per_part = (count + parts - 1) / parts;
+        pool.run((count + per_part - 1) / per_part, [&](size_t part) {
+            work(part * per_part, std::min(count, (part + 1) * per_part));
+        });
+    }
 
-                out.write(reinterpret_cast<const char *>(out_buf.data()), buf_size);
-            }
-            mp::cpp_int encrypted_value;
-            mp::import_bits(encrypted_value, buf.begin(), buf.end(), 8, false);
-            auto decrypted = math::mod_pow(encrypted_value, key.exponent, key.modulus);
-            std::vector<uint8_t> out_buf(buf_size, 0);
-            mp::export_bits(decrypted, out_buf.begin(), 8, false);
-            auto pad = out_buf.back();
-            out_buf.resize(buf_size - pad);
-            out.write(reinterpret_cast<const char *>(out_buf.data()), buf_size - pad);
-        };
-        return std::async(std::launch::async, std::move(task));
+    /*
+     * Блоки читаются пачками по _blocks_per_thread на поток, возведения в степень пачки распределяются
+     * между потоками (каждому - непрерывный отрезок), результаты пишутся по порядку.
+     * В выход попадает не больше out_length байт: так отбрасывается дополнение последнего блока
+     */
+    void RSACryptoService::process_blocks(std::istream &in, std::ostream &out, uint64_t blocks_count,
+                                          size_t in_block, size_t out_block, uint64_t out_length,
+                                          WorkerPool &pool, const std::function<big_int(const big_int &)> &transform) {
+        const size_t batch = pool.get_threads_count() * _blocks_per_thread;
+        std::vector<uint8_t> in_buf(batch * in_block);
+        std::vector<uint8_t> out_buf(batch * out_block);
+
+        for (uint64_t done = 0; done < blocks_count;) {
+            const size_t count = std::min<uint64_t>(batch, blocks_count - done);
+            std::fill_n(in_buf.begin(), count * in_block, 0);
+            in.read(reinterpret_cast<char *>(in_buf.data()), static_cast<std::streamsize>(count * in_block));
+
+            parallel_for(pool, count, [&](size_t from, size_t to) {
+                for (size_t i = from; i < to; ++i) {
+                    const auto value = math::import_bytes(std::span(in_buf).subspan(i * in_block, in_block));
+                    math::export_bytes(transform(value), std::span(out_buf).subspan(i * out_block, out_block));
+                }
+            });
+
+            const uint64_t written = done * out_block;
+            const size_t length = std::min<uint64_t>(count * out_block, out_length - std::min(out_length, written));
+            out.write(reinterpret_cast<const char *>(out_buf.data()), static_cast<std::streamsize>(length));
+            done += count;
+        }
+        if (!out)
+            throw std::runtime_error("failed to write output file");
     }
 
 
@@ -127,20 +262,27 @@ namespace crypto::rsa {
         _key_pair.publicKey = std::move(pub_key);
     }
 
+    void RSACryptoService::set_private_key(KeyRSA priv_key, std::optional<CRTParams> crt) {
+        _key_pair.privateKey = std::move(priv_key);
+        _key_pair.crt = std::move(crt);
+    }
+
 
     RSACryptoService::RSAKeyGenerator::KeyPairRSA RSACryptoService::RSAKeyGenerator::generate_key_pair() const {
         static const big_int exponents[] = {big_int(17), big_int(257), big_int(65537)};
 
-        auto [p, q] = generate_prime_pair();
-        big_int N = p * q;
-        big_int phi = (p - 1) * (q - 1);
+        const auto primes = generate_primes();
+        big_int N = 1, phi = 1;
+        for (const auto &prime: primes) {
+            N *= prime;
+            phi *= prime - 1;
+        }
         big_int encrypt_exp{0};
         big_int decrypt_exp{0};
 
         for (const auto &e: exponents) {
             if (math::gcd(e, phi) == 1) {
-                big_int inverse = std::get<1>(math::egcd(e, phi));
-                decrypt_exp = (inverse % phi + phi) % phi;
+                decrypt_exp = math::mod_inverse(e, phi);
                 if (boost::multiprecision::pow(decrypt_exp, 4) * 81 >= N) {
                     encrypt_exp = e;
                     break;
@@ -150,13 +292,12 @@ namespace crypto::rsa {
         if (!encrypt_exp) {
             while (true) {
                 namespace rnd = boost::random;
-                static rnd::mt19937 gen(static_cast<unsigned int>(std::time(nullptr)));
+                thread_local rnd::mt19937 gen(std::random_device{}());
                 const rnd::uniform_int_distribution<big_int> dist(big_int(3), phi - 1);
                 big_int e = dist(gen) | 1;
                 big_int gcd = math::gcd(e, phi);
                 if (gcd == 1) {
-                    big_int inverse = std::get<1>(math::egcd(e, phi));
-                    decrypt_exp = (inverse % phi + phi) % phi;
+                    decrypt_exp = math::mod_inverse(e, phi);
                     if (boost::multiprecision::pow(decrypt_exp, 4) * 81 >= N) {
                         encrypt_exp = e;
                         break;
@@ -164,15 +305,17 @@ namespace crypto::rsa {
                 }
             }
         }
+        auto crt = CRTParams::from_primes(primes, decrypt_exp);
         return KeyPairRSA{
             {std::move(encrypt_exp), N},
-            {std::move(decrypt_exp), std::move(N)}
+            {std::move(decrypt_exp), std::move(N)},
+            std::move(crt)
         };
     }
 
     RSACryptoService::RSAKeyGenerator::KeyPairRSA RSACryptoService::RSAKeyGenerator::generate_weak_key_pair() const {
         namespace rnd = boost::random;
-        static rnd::mt19937 gen(static_cast<unsigned int>(std::time(nullptr)));
+        thread_local rnd::mt19937 gen(std::random_device{}());
         auto [p, q] = generate_prime_pair();
         big_int N = p * q;
         big_int phi = (p - 1) * (q - 1);
@@ -182,15 +325,16 @@ namespace crypto::rsa {
         while (true) {
             decrypt_exp = dist(gen);
             if (math::gcd(decrypt_exp, phi) != 1) continue;
-            auto inverse = std::get<1>(math::egcd(decrypt_exp, phi));
-            encrypt_exp = (inverse % phi + phi) % phi;
+            encrypt_exp = math::mod_inverse(decrypt_exp, phi);
             if (math::gcd(encrypt_exp, phi) == 1) {
                 break;
             }
         }
+        auto crt = CRTParams::from_primes(p, q, decrypt_exp);
         return KeyPairRSA{
             {std::move(encrypt_exp), N},
-            {std::move(decrypt_exp), std::move(N)}
+            {std::move(decrypt_exp), std::move(N)},
+            std::move(crt)
         };
     }
 
@@ -200,48 +344,99 @@ namespace crypto::rsa {
           _min_probability{min_probability},
           _prime_bit_len{prime_bit_len} {}
 
-    big_int RSACryptoService::RSAKeyGenerator::generate_prime_candidate() const {
-        namespace rnd = boost::random;
-        static rnd::mt19937 gen(static_cast<unsigned int>(std::time(nullptr)));
-        big_int l_border = mp::pow(big_int(2), _prime_bit_len - 1);
-        big_int r_border = (l_border * 2) - 1;
-        const rnd::uniform_int_distribution dist(std::move(l_border), std::move(r_border));
-        return dist(gen) | 1;
+    /*
+     * p = 0xFF... (старшие 8 бит установлены), q = 0b1000000000... (следующие 8 бит сброшены),
+     * поэтому p - q > 2^(bits - 2) и p, q не близки. Каждое простое ищется всеми потоками сразу
+     */
+    std::pair<big_int, big_int> RSACryptoService::RSAKeyGenerator::generate_prime_pair() const {
+        if (_p_pool && _q_pool) {
+            return {_p_pool->pop(), _q_pool->pop()};
+        }
+        const auto is_prime = prime_predicate();
+        const primary::PrimeSearch search(_threads_count);
+        const auto [p_low, p_high] = prime_range(true);
+        const auto [q_low, q_high] = prime_range(false);
+        big_int p = search.find(p_low, p_high, is_prime);
+        big_int q = search.find(q_low, q_high, is_prime);
+        return {std::move(p), std::move(q)};
     }
 
+    /*
+     * У каждого из k простых старшие 8 бит установлены, поэтому произведение не меньше (255/256)^k * 2^bits
+     * и при k <= 4 имеет ровно bits = 2 * _prime_bit_len бит
+     */
+    std::vector<big_int> RSACryptoService::RSAKeyGenerator::generate_primes() const {
+        if (_primes_count == 2) {
+            auto [p, q] = generate_prime_pair();
+            return {std::move(p), std::move(q)};
+        }
+        const auto is_prime = prime_predicate();
+        const primary::PrimeSearch search(_threads_count);
+        const size_t bits = 2 * _prime_bit_len;
+        std::vector<big_int> primes;
+        while (primes.size() < _primes_count) {
+            const size_t prime_bits = bits / _primes_count + (primes.size() < bits % _primes_count);
+            big_int prime = search.find(big_int(0xFF) << (prime_bits - 8), (big_int(1) << prime_bits) - 1, is_prime);
+            if (std::ranges::find(primes, prime) == primes.end()) primes.push_back(std::move(prime));
+        }
+        return primes;
+    }
 
-    std::pair<big_int, big_int> RSACryptoService::RSAKeyGenerator::generate_prime_pair() const {
-        const big_int set_mask = (big_int(0xFF) << (_prime_bit_len - 8));
-        const big_int clear_mask = ((big_int(1) << _prime_bit_len) - 1) ^ (big_int(0xFF) << (_prime_bit_len - 8 - 1));
-        big_int p, q;
-        std::unique_ptr<primary::IProbabilisticPrimalityTest> test;
+    void RSACryptoService::RSAKeyGenerator::set_primes_count(size_t primes_count) {
+        if (primes_count < 2 || primes_count > 4)
+            throw std::invalid_argument("primes count must be in [2; 4]");
+        _primes_count = primes_count;
+    }
+
+    // Предикат владеет тестом: тест живёт, пока его используют фоновые потоки пула
+    primary::PrimeSearch::Predicate RSACryptoService::RSAKeyGenerator::prime_predicate() const {
+        std::shared_ptr<const primary::IProbabilisticPrimalityTest> test;
         switch (_test_type) {
             case PrimalityTestType::FERMAT:
-                test = std::make_unique<primary::FermatTest>();
+                test = std::make_shared<primary::FermatTest>();
                 break;
             case PrimalityTestType::SOLOVAY_STRASSEN:
-                test = std::make_unique<primary::SolovayStrassenTest>();
+                test = std::make_shared<primary::SolovayStrassenTest>();
                 break;
             case PrimalityTestType::MILLER_RABIN:
-                test = std::make_unique<primary::MillerRabinTest>();
+                test = std::make_shared<primary::MillerRabinTest>();
+                break;
+            case PrimalityTestType::BAILLIE_PSW:
+                test = std::make_shared<primary::BailliePSWTest>();
                 break;
         }
-        auto func = [this, &test, &set_mask]() {
-            while (true) {
-                big_int p = generate_prime_candidate();
-                p |= set_mask;
-                if (test->is_primary(p, _min_probability)) {
-                    return p;
-                }
-            }
+        return [test = std::move(test), probability = _min_probability](const big_int &candidate) {
+            return test->is_primary(candidate, probability);
         };
-        auto p_fut = std::async(std::launch::async, func);
-        while (true) {
-            q = generate_prime_candidate();
-            q &= clear_mask;
-            if (test->is_primary(q, _min_probability)) break;
+    }
+
+    std::pair<big_int, big_int> RSACryptoService::RSAKeyGenerator::prime_range(bool upper) const {
+        const big_int top = big_int(1) << (_prime_bit_len - 1);
+        if (upper) {
+            return {big_int(0xFF) << (_prime_bit_len - 8), (top << 1) - 1};
         }
-        return {p_fut.get(), q};
+        return {top, top + (big_int(1) << (_prime_bit_len - 9)) - 1};
+    }
+
+    void RSACryptoService::RSAKeyGenerator::enable_prime_pool(size_t depth, std::chrono::milliseconds refill_pause) {
+        disable_prime_pool();
+        auto [p_low, p_high] = prime_range(true);
+        auto [q_low, q_high] = prime_range(false);
+        _p_pool = std::make_unique<primary::PrimePool>(std::move(p_low), std::move(p_high), prime_predicate(), depth,
+                                                       refill_pause);
+        _q_pool = std::make_unique<primary::PrimePool>(std::move(q_low), std::move(q_high), prime_predicate(), depth,
+                                                       refill_pause);
+    }
+
+    void RSACryptoService::RSAKeyGenerator::disable_prime_pool() {
+        _p_pool.reset();
+        _q_pool.reset();
+    }
+
+    std::optional<std::pair<primary::PrimePool::Stats, primary::PrimePool::Stats> >
+    RSACryptoService::RSAKeyGenerator::get_prime_pool_stats() const {
+        if (!_p_pool || !_q_pool) return std::nullopt;
+        return std::pair{_p_pool->stats(), _q_pool->stats()};
     }
 
     std::vector<big_int> WienerAttack::continued_fraction(const rational &x) {
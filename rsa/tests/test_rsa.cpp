@@ -1,6 +1,17 @@
 #include <gtest/gtest.h>
 #include "rsa.h"
+#include "primary_tests.h"
+#include "prime_search.h"
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <algorithm>
+#include <atomic>
 #include <exception>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
 
 class RSACryptoTest : public ::testing::Test {
 protected:
@@ -172,6 +183,611 @@ TEST_F(RSACryptoTest, WienerAttackResistance) {
     EXPECT_FALSE(std::get<0>(crypto::rsa::WienerAttack::attack(*rsa_strassen)));
 }
 
+// Тест 7: Расшифрование по CRT совпадает с полным возведением в степень, ключи без CRT работают
+TEST_F(RSACryptoTest, CRTDecryption) {
+    for (auto *rsa: {rsa_fermat.get(), rsa_miller.get()}) {
+        ASSERT_TRUE(rsa->get_crt_params().has_value());
+        const auto priv_key = rsa->get_priv_key();
+        const auto crt = *rsa->get_crt_params();
+        EXPECT_EQ(priv_key.modulus, crt.p * crt.q);
+
+        const auto cipher = rsa->encrypt(test_data1);
+        const size_t rounds = 5;
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < rounds; ++i) EXPECT_EQ(test_data1, rsa->decrypt(cipher));
+        const std::chrono::duration<double, std::milli> with_crt = std::chrono::steady_clock::now() - start;
+
+        rsa->set_parallel_crt(true);
+        EXPECT_EQ(test_data1, rsa->decrypt(cipher));
+        rsa->set_parallel_crt(false);
+
+        rsa->set_private_key(priv_key);
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < rounds; ++i) EXPECT_EQ(test_data1, rsa->decrypt(cipher));
+        const std::chrono::duration<double, std::milli> without_crt = std::chrono::steady_clock::now() - start;
+        rsa->set_private_key(priv_key, crt);
+
+        std::cout << "RSA-" << crypto::mp::msb(priv_key.modulus) + 1 << " decrypt: CRT " << with_crt.count() / rounds
+                << " ms, full " << without_crt.count() / rounds << " ms" << std::endl;
+    }
+}
+
+// Тест 8: mpz_powm, mpz_powm_sec и обобщённый вариант (Монтгомери для нечётного модуля) совпадают
+TEST(ModPowTest, BackendsAgree) {
+    boost::random::mt19937 gen(17);
+    for (size_t bits: {64, 521, 2048}) {
+        const boost::random::uniform_int_distribution<crypto::big_int> dist(crypto::big_int(1),
+                                                                            (crypto::big_int(1) << bits) - 1);
+        for (size_t i = 0; i < 4; ++i) {
+            const crypto::big_int a = dist(gen), pow = dist(gen);
+            const crypto::big_int odd_mod = dist(gen) | 1, even_mod = dist(gen) << 1;
+            const auto expected = crypto::math::mod_pow(a, pow, odd_mod);
+
+            EXPECT_EQ(expected, crypto::math::mod_pow_sec(a, pow, odd_mod));
+            EXPECT_EQ(expected, crypto::big_int(crypto::math::mod_pow(
+                          crypto::mp::cpp_int(a), crypto::mp::cpp_int(pow), crypto::mp::cpp_int(odd_mod))));
+            EXPECT_EQ(crypto::math::mod_pow(a, pow, even_mod), crypto::big_int(crypto::math::mod_pow(
+                          crypto::mp::cpp_int(a), crypto::mp::cpp_int(pow), crypto::mp::cpp_int(even_mod))));
+        }
+    }
+    EXPECT_EQ(1, crypto::math::mod_pow(crypto::big_int(5), crypto::big_int(0), crypto::big_int(7)));
+    EXPECT_EQ(2, crypto::math::mod_pow(crypto::big_int(-5), crypto::big_int(1), crypto::big_int(7)));
+    EXPECT_THROW(crypto::math::mod_pow(crypto::big_int(5), crypto::big_int(-1), crypto::big_int(7)),
+                 std::invalid_argument);
+
+    std::vector<uint8_t> bytes{0x01, 0x02, 0x03, 0x00};
+    const auto value = crypto::math::import_bytes(bytes);
+    EXPECT_EQ(0x030201, value);
+    std::vector<uint8_t> exported(6, 0xFF);
+    crypto::math::export_bytes(value, exported);
+    EXPECT_EQ((std::vector<uint8_t>{0x01, 0x02, 0x03, 0x00, 0x00, 0x00}), exported);
+    EXPECT_THROW(crypto::math::export_bytes(value, std::span(exported).first(2)), std::invalid_argument);
+}
+
+TEST(ModInverseTest, BackendsAgree) {
+    using crypto::big_int;
+    using crypto::mp::cpp_int;
+    boost::random::mt19937 gen(23);
+    for (size_t bits: {64, 521, 2048}) {
+        const boost::random::uniform_int_distribution<big_int> dist(big_int(1), (big_int(1) << bits) - 1);
+        for (size_t i = 0; i < 8; ++i) {
+            const big_int a = dist(gen), m = dist(gen) + 1;
+            const big_int g = crypto::math::gcd(a, m);
+            EXPECT_EQ(g, big_int(crypto::math::gcd(cpp_int(a), cpp_int(m))));
+            EXPECT_EQ(g, crypto::math::gcd(big_int(-a), m));
+
+            const auto [d, x, y] = crypto::math::egcd(a, m);
+            EXPECT_EQ(d, g);
+            EXPECT_EQ(a * x + m * y, d);
+
+            if (g == 1) {
+                const big_int inverse = crypto::math::mod_inverse(a, m);
+                EXPECT_TRUE(inverse >= 0 && inverse < m);
+                EXPECT_EQ(1, a * inverse % m);
+                EXPECT_EQ(inverse, big_int(crypto::math::mod_inverse(cpp_int(a), cpp_int(m))));
+            }
+            else {
+                EXPECT_THROW(crypto::math::mod_inverse(a, m), std::invalid_argument);
+                EXPECT_THROW(crypto::math::mod_inverse(cpp_int(a), cpp_int(m)), std::invalid_argument);
+            }
+        }
+    }
+    EXPECT_EQ(4, crypto::math::mod_inverse(big_int(-5), big_int(7)));
+    EXPECT_THROW(crypto::math::mod_inverse(big_int(6), big_int(9)), std::invalid_argument);
+}
+
+TEST(JacobiTest, BackendsAgree) {
+    using crypto::big_int;
+    using crypto::mp::cpp_int;
+    // для простого p символ Лежандра совпадает с критерием Эйлера a^((p - 1) / 2)
+    const big_int p = (big_int(1) << 127) - 1;
+    boost::random::mt19937 gen(29);
+    const boost::random::uniform_int_distribution<big_int> dist(big_int(1), (big_int(1) << 521) - 1);
+    for (size_t i = 0; i < 32; ++i) {
+        const big_int a = dist(gen) % p;
+        const big_int euler = crypto::math::mod_pow(a, big_int((p - 1) / 2), p);
+        EXPECT_EQ(crypto::math::jacobi_symbol(a, p), a == 0 ? 0 : euler == 1 ? 1 : -1);
+
+        const big_int b = dist(gen), n = dist(gen) | 1;
+        const int expected = crypto::math::jacobi_symbol(b, n);
+        EXPECT_EQ(expected, crypto::math::jacobi_symbol(cpp_int(b), cpp_int(n)));
+        EXPECT_EQ(crypto::math::jacobi_symbol(big_int(-b), n), crypto::math::jacobi_symbol(cpp_int(-b), cpp_int(n)));
+        EXPECT_EQ(0, crypto::math::jacobi_symbol(big_int(n * 3), big_int(n * 5)));
+        EXPECT_EQ(0, crypto::math::jacobi_symbol(cpp_int(n * 3), cpp_int(n * 5)));
+    }
+    EXPECT_EQ(-1, crypto::math::jacobi_symbol(big_int(2), big_int(3)));
+    EXPECT_EQ(-1, crypto::math::jacobi_symbol(cpp_int(1001), cpp_int(9907)));
+    EXPECT_THROW(crypto::math::jacobi_symbol(big_int(3), big_int(10)), std::invalid_argument);
+}
+
+TEST(ModPowTest, Benchmark2048) {
+    boost::random::mt19937 gen(3);
+    const boost::random::uniform_int_distribution<crypto::big_int> dist(crypto::big_int(1),
+                                                                        (crypto::big_int(1) << 2048) - 1);
+    const crypto::big_int a = dist(gen), pow = dist(gen), mod = dist(gen) | 1;
+    const size_t rounds = 20;
+
+    auto measure = [rounds](auto &&function) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < rounds; ++i) function();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / rounds;
+    };
+    const double gmp = measure([&] { return crypto::math::mod_pow(a, pow, mod); });
+    const double gmp_sec = measure([&] { return crypto::math::mod_pow_sec(a, pow, mod); });
+    const crypto::mp::cpp_int a_cpp(a), pow_cpp(pow), mod_cpp(mod);
+    const double montgomery = measure([&] { return crypto::math::mod_pow(a_cpp, pow_cpp, mod_cpp); });
+    std::cout << "mod_pow 2048: mpz_powm " << gmp << " ms, mpz_powm_sec " << gmp_sec
+            << " ms, cpp_int Montgomery " << montgomery << " ms" << std::endl;
+}
+
+TEST(ModPowTest, FixedBaseComb) {
+    using crypto::big_int;
+    boost::random::mt19937 gen(31);
+    const boost::random::uniform_int_distribution<big_int> dist(big_int(1), (big_int(1) << 1024) - 1);
+    for (size_t exp_bits: {1, 7, 64, 226}) {
+        for (size_t rows: {1, 4, 6}) {
+            const big_int base = dist(gen), mod = dist(gen) | 1;
+            const crypto::math::FixedBasePow comb(base, mod, exp_bits, rows);
+            const boost::random::uniform_int_distribution<big_int> exp_dist(big_int(0), (big_int(1) << exp_bits) - 1);
+            for (size_t i = 0; i < 8; ++i) {
+                const big_int exp = exp_dist(gen);
+                EXPECT_EQ(crypto::math::mod_pow(base, exp, mod), comb.pow(exp)) << exp_bits << " " << rows;
+            }
+            // показатель длиннее таблицы считается обычным возведением
+            const big_int long_exp = dist(gen);
+            EXPECT_EQ(crypto::math::mod_pow(base, long_exp, mod), comb.pow(long_exp));
+        }
+    }
+    const crypto::math::FixedBasePow even(big_int(-3), big_int(10), 16);
+    EXPECT_EQ(1, even.pow(big_int(0)));
+    EXPECT_EQ(crypto::math::mod_pow(big_int(7), big_int(12345), big_int(10)), even.pow(big_int(12345)));
+    EXPECT_EQ(crypto::math::mod_pow(big_int(7), big_int(1) << 40, big_int(10)), even.pow(big_int(1) << 40));
+    EXPECT_EQ(0, crypto::math::FixedBasePow(big_int(5), big_int(5), 8).pow(big_int(3)));
+    EXPECT_THROW(even.pow(big_int(-1)), std::invalid_argument);
+    EXPECT_THROW(crypto::math::FixedBasePow(big_int(2), big_int(1), 8), std::invalid_argument);
+    EXPECT_THROW(crypto::math::FixedBasePow(big_int(2), big_int(7), 0), std::invalid_argument);
+    EXPECT_THROW(crypto::math::FixedBasePow(big_int(2), big_int(7), 8, 11), std::invalid_argument);
+}
+
+TEST(ModPowTest, FixedBaseBenchmark) {
+    using crypto::big_int;
+    boost::random::mt19937 gen(37);
+    const boost::random::uniform_int_distribution<big_int> dist(big_int(1), (big_int(1) << 2048) - 1);
+    const big_int base = dist(gen), mod = dist(gen) | 1;
+    const boost::random::uniform_int_distribution<big_int> exp_dist(big_int(1) << 225, (big_int(1) << 226) - 1);
+    std::vector<big_int> exps(50);
+    for (auto &exp: exps) exp = exp_dist(gen);
+
+    auto measure = [&exps](auto &&function) {
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto &exp: exps) function(exp);
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / exps.size();
+    };
+    const auto build_start = std::chrono::steady_clock::now();
+    const crypto::math::FixedBasePow comb(base, mod, 226);
+    const double build = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - build_start).count();
+    const double sec = measure([&](const big_int &exp) { return crypto::math::mod_pow_sec(base, exp, mod); });
+    const double fixed = measure([&](const big_int &exp) { return comb.pow(exp); });
+    std::cout << "2048-bit modulus, 226-bit exponent: mpz_powm_sec " << sec << " us, comb " << fixed
+            << " us (table " << build << " us)" << std::endl;
+}
+
+// Тест 9: Шифрование файлов блоками в несколько потоков, включая размеры на границах блоков
+TEST_F(RSACryptoTest, FileEncryptionRoundTrip) {
+    auto write_random = [](const std::filesystem::path &path, size_t size) {
+        std::vector<char> data(size);
+        std::mt19937 gen(static_cast<unsigned>(size));
+        std::ranges::generate(data, [&gen] { return static_cast<char>(gen()); });
+        std::ofstream(path, std::ios::binary).write(data.data(), static_cast<std::streamsize>(size));
+        return data;
+    };
+    auto read_all = [](const std::filesystem::path &path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    };
+
+    const size_t plain_block = crypto::mp::msb(rsa_fermat->get_public_key().modulus) / 8;
+    for (size_t size: {size_t{0}, size_t{1}, plain_block - 1, plain_block, plain_block + 1, size_t{20'000}}) {
+        const auto data = write_random("rsa_plain.bin", size);
+        for (size_t threads: {1, 3}) {
+            rsa_fermat->set_threads_count(threads);
+            rsa_fermat->encrypt("rsa_plain.bin", "rsa_enc.bin").get();
+            rsa_fermat->decrypt("rsa_enc.bin", "rsa_dec.bin").get();
+            EXPECT_EQ(data, read_all("rsa_dec.bin")) << "size: " << size << ", threads: " << threads;
+        }
+    }
+    rsa_fermat->set_threads_count(0);
+
+    std::filesystem::resize_file("rsa_enc.bin", std::filesystem::file_size("rsa_enc.bin") - 1);
+    EXPECT_THROW(rsa_fermat->decrypt("rsa_enc.bin", "rsa_dec.bin").get(), std::runtime_error);
+
+    for (const auto *path: {"rsa_plain.bin", "rsa_enc.bin", "rsa_dec.bin"}) {
+        std::filesystem::remove(path);
+    }
+}
+
+TEST_F(RSACryptoTest, FileDecryptionBenchmark2048) {
+    {
+        std::vector<char> data(256 << 10, 'x');
+        std::ofstream("rsa_bench.bin", std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+    rsa_fermat->encrypt("rsa_bench.bin", "rsa_bench.enc").get();
+
+    for (size_t threads: {size_t{1}, size_t{0}}) {
+        rsa_fermat->set_threads_count(threads);
+        const auto start = std::chrono::steady_clock::now();
+        rsa_fermat->decrypt("rsa_bench.enc", "rsa_bench.dec").get();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "RSA-2048 file decrypt (256 KiB), threads " << (threads ? threads : std::thread::hardware_concurrency())
+                << ": " << elapsed.count() << " s" << std::endl;
+    }
+    rsa_fermat->set_threads_count(0);
+
+    for (const auto *path: {"rsa_bench.bin", "rsa_bench.enc", "rsa_bench.dec"}) {
+        std::filesystem::remove(path);
+    }
+}
+
+TEST(RSAKeyGenerationTest, SieveSkipsNoPrimes) {
+    // ниже 2^30 число без делителей меньше 2^15 - простое, поэтому решето должно выдать ровно простые
+    auto is_prime = [](uint64_t n) {
+        for (uint64_t d = 2; d * d <= n; ++d) {
+            if (n % d == 0) return false;
+        }
+        return n > 1;
+    };
+    crypto::primary::IncrementalSieve sieve(3);
+    for (uint64_t n = 3; n < 3 * 2 * crypto::primary::IncrementalSieve::WINDOW; n += 2) {
+        if (is_prime(n)) {
+            EXPECT_EQ(sieve.next(), n);
+        }
+    }
+}
+
+TEST(RSAKeyGenerationTest, ParallelPrimeSearch) {
+    auto is_prime = [](const crypto::big_int &n) {
+        for (crypto::big_int d = 2; d * d <= n; ++d) {
+            if (n % d == 0) return false;
+        }
+        return n > 1;
+    };
+    const crypto::primary::PrimeSearch search(4);
+    for (int i = 0; i < 20; ++i) {
+        const crypto::big_int p = search.find(1000, 1100, is_prime);
+        EXPECT_TRUE(p >= 1000 && p <= 1100 && is_prime(p)) << p;
+    }
+
+    const crypto::primary::MillerRabinTest test;
+    const crypto::big_int low = crypto::big_int(1) << 511;
+    const crypto::big_int p = search.find(low, (low << 1) - 1, [&test](const crypto::big_int &n) {
+        return test.is_primary(n, 0.999);
+    });
+    EXPECT_EQ(crypto::mp::msb(p), 511);
+}
+
+TEST(PrimalityTest, BailliePSW) {
+    using crypto::primary::BailliePSWTest;
+    const BailliePSWTest test;
+    constexpr uint32_t limit = 1'200'000;
+    std::vector<bool> composite(limit);
+    for (uint32_t i = 2; i * i < limit; ++i) {
+        if (composite[i]) continue;
+        for (uint32_t j = i * i; j < limit; j += i) composite[j] = true;
+    }
+    for (uint32_t n = 1'000'001; n < limit; n += 2) {
+        ASSERT_EQ(test.is_primary(n, 0.999), !composite[n]) << n;
+        ASSERT_EQ(BailliePSWTest::strong_probable_prime(n, 2) && BailliePSWTest::strong_lucas_probable_prime(n),
+                  !composite[n]) << n;
+    }
+
+    // сильные псевдопростые по основанию 2 и сильные псевдопростые Люка
+    for (const uint32_t n: {2047u, 3277u, 4033u, 4681u, 8321u}) {
+        EXPECT_TRUE(BailliePSWTest::strong_probable_prime(n, 2)) << n;
+    }
+    for (const uint32_t n: {5459u, 5777u, 10877u, 16109u, 18971u, 22499u, 24569u, 25199u, 40309u, 58519u}) {
+        EXPECT_TRUE(BailliePSWTest::strong_lucas_probable_prime(n)) << n;
+        EXPECT_FALSE(BailliePSWTest::strong_probable_prime(n, 2)) << n;
+    }
+    // = 149491 * 747451 * 34233211, сильное псевдопростое по основаниям 2..23
+    const crypto::big_int spsp("3825123056546413051");
+    EXPECT_TRUE(BailliePSWTest::strong_probable_prime(spsp, 2));
+    EXPECT_FALSE(test.is_primary(spsp, 0.999));
+
+    const crypto::big_int m521 = (crypto::big_int(1) << 521) - 1;
+    EXPECT_TRUE(test.is_primary(m521, 0.999));
+    EXPECT_FALSE(test.is_primary((crypto::big_int(1) << 523) - 1, 0.999));
+    EXPECT_FALSE(test.is_primary(m521 * ((crypto::big_int(1) << 607) - 1), 0.999));
+}
+
+TEST(PrimalityTest, DeterministicU64) {
+    constexpr uint32_t limit = 1 << 20;
+    std::vector<bool> composite(limit);
+    composite[0] = composite[1] = true;
+    for (uint32_t i = 2; i * i < limit; ++i) {
+        if (composite[i]) continue;
+        for (uint32_t j = i * i; j < limit; j += i) composite[j] = true;
+    }
+    for (uint32_t n = 0; n < limit; ++n) {
+        ASSERT_EQ(crypto::primary::is_prime_u64(n), !composite[n]) << n;
+    }
+
+    // сильные псевдопростые по нескольким первым простым основаниям
+    for (const uint64_t n: {3215031751ull, 2152302898747ull, 3474749660383ull, 341550071728321ull,
+                            3825123056546413051ull}) {
+        EXPECT_FALSE(crypto::primary::is_prime_u64(n)) << n;
+    }
+    const uint64_t max_prime = 18446744073709551557ull; // наибольшее простое меньше 2^64
+    EXPECT_TRUE(crypto::primary::is_prime_u64(max_prime));
+    EXPECT_TRUE(crypto::primary::is_prime_u64(4294967291ull));
+    EXPECT_FALSE(crypto::primary::is_prime_u64(4294967291ull * 4294967279ull));
+
+    // автоматический выбор пути в тестах на big_int
+    const crypto::primary::MillerRabinTest miller_rabin;
+    const crypto::primary::FermatTest fermat;
+    EXPECT_TRUE(miller_rabin.is_primary(max_prime, 0.999));
+    EXPECT_FALSE(fermat.is_primary(crypto::big_int(561), 0.999));
+    EXPECT_FALSE(miller_rabin.is_primary(crypto::big_int(max_prime) * 3, 0.999));
+}
+
+TEST(PrimalityTest, BenchmarkU64) {
+    boost::random::mt19937_64 gen(42);
+    std::vector<uint64_t> numbers(20000);
+    for (auto &n: numbers) n = gen() | (1ull << 63) | 1;
+
+    const crypto::primary::MillerRabinTest test;
+    auto start = std::chrono::steady_clock::now();
+    size_t native_primes = 0;
+    for (const auto n: numbers) native_primes += test.is_primary(n, 0.999999);
+    const std::chrono::duration<double> native = std::chrono::steady_clock::now() - start;
+
+    // прежний путь: те же основания через mpz_powm
+    start = std::chrono::steady_clock::now();
+    size_t big_primes = 0;
+    for (const auto n: numbers) {
+        const crypto::big_int big_n = n;
+        bool prime = true;
+        for (const uint64_t base: {2ull, 325ull, 9375ull, 28178ull, 450775ull, 9780504ull, 1795265022ull}) {
+            if (base % n != 0 && !crypto::primary::BailliePSWTest::strong_probable_prime(big_n, base % n)) {
+                prime = false;
+                break;
+            }
+        }
+        big_primes += prime;
+    }
+    const std::chrono::duration<double> big = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(native_primes, big_primes);
+    std::cout << "64-bit primality: native " << numbers.size() / native.count() << " tests/s, big_int "
+            << numbers.size() / big.count() << " tests/s" << std::endl;
+}
+
+TEST(PrimalityTest, ParallelRounds) {
+    crypto::primary::MillerRabinTest test;
+    test.set_threads_count(4);
+    const crypto::big_int m521 = (crypto::big_int(1) << 521) - 1;
+    EXPECT_TRUE(test.is_primary_rounds(m521, 64));
+    EXPECT_FALSE(test.is_primary_rounds((crypto::big_int(1) << 523) - 1, 64));
+    // произведение двух простых Мерсенна: малых делителей нет
+    EXPECT_FALSE(test.is_primary_rounds(m521 * ((crypto::big_int(1) << 127) - 1), 64));
+    EXPECT_TRUE(test.is_primary(m521, 0.999999));
+}
+
+TEST(WorkerPoolTest, RunsEveryTaskAndRethrows) {
+    crypto::WorkerPool pool(4);
+    std::vector<std::atomic<int> > hits(1000);
+    pool.run(hits.size(), [&](size_t i) { ++hits[i]; });
+    EXPECT_TRUE(std::ranges::all_of(hits, [](const auto &hit) { return hit == 1; }));
+
+    // вложенные и одновременные вызовы run на одном пуле
+    std::atomic<size_t> total{0};
+    std::vector<std::jthread> callers;
+    for (size_t i = 0; i < 3; ++i) {
+        callers.emplace_back([&] {
+            pool.run(8, [&](size_t) { pool.run(8, [&](size_t) { ++total; }); });
+        });
+    }
+    callers.clear();
+    EXPECT_EQ(3 * 8 * 8, total);
+
+    EXPECT_THROW(pool.run(100, [](size_t i) { if (i == 37) throw std::runtime_error("task failed"); }),
+                 std::runtime_error);
+    pool.run(0, [](size_t) { FAIL(); });
+}
+
+TEST(PrimalityTest, ParallelRoundsBenchmark2048) {
+    const crypto::primary::PrimeSearch search(1);
+    const crypto::primary::BailliePSWTest bpsw;
+    const crypto::big_int low = crypto::big_int(1) << 2047;
+    const crypto::big_int p = search.find(low, (low << 1) - 1, [&bpsw](const crypto::big_int &n) {
+        return bpsw.is_primary(n, 0.999);
+    });
+    crypto::primary::MillerRabinTest test;
+    for (const size_t threads: {size_t{1}, size_t{std::max(1u, std::thread::hardware_concurrency())}}) {
+        test.set_threads_count(threads);
+        const auto start = std::chrono::steady_clock::now();
+        EXPECT_TRUE(test.is_primary_rounds(p, 64));
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "2048-bit prime, 64 Miller-Rabin rounds, threads " << threads << ": " << elapsed.count()
+                << " ms" << std::endl;
+    }
+}
+
+TEST(PrimalityTest, Benchmark1024) {
+    const crypto::primary::PrimeSearch search(1);
+    const crypto::primary::BailliePSWTest bpsw;
+    const crypto::primary::MillerRabinTest miller_rabin;
+    const crypto::big_int low = crypto::big_int(1) << 1023;
+    const crypto::big_int p = search.find(low, (low << 1) - 1, [&bpsw](const crypto::big_int &n) {
+        return bpsw.is_primary(n, 0.999);
+    });
+    const size_t rounds = 20;
+    auto measure = [&](const crypto::primary::IProbabilisticPrimalityTest &test) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < rounds; ++i) {
+            EXPECT_TRUE(test.is_primary(p, 0.999999));
+        }
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / rounds;
+    };
+    std::cout << "1024-bit prime, Miller-Rabin (p = 0.999999): " << measure(miller_rabin) << " ms, Baillie-PSW: "
+            << measure(bpsw) << " ms" << std::endl;
+}
+
+TEST(RSAKeyGenerationTest, Benchmark2048) {
+    crypto::rsa::RSACryptoService rsa(1024);
+    const size_t rounds = 5;
+    for (const size_t threads: {size_t{1}, size_t{std::max(1u, std::thread::hardware_concurrency())}}) {
+        rsa.set_threads_count(threads);
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < rounds; ++i) {
+            rsa.generate_key_pair();
+            const auto crt = rsa.get_crt_params();
+            ASSERT_TRUE(crt.has_value());
+            EXPECT_EQ(1024, crypto::mp::msb(crt->p) + 1);
+            EXPECT_EQ(1024, crypto::mp::msb(crt->q) + 1);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "RSA-2048 key generation, " << threads << " threads: " << elapsed.count() / rounds << " s"
+                << std::endl;
+    }
+}
+
+TEST(RSAKeyGenerationTest, PrimePool) {
+    crypto::rsa::RSACryptoService rsa(1024);
+    EXPECT_FALSE(rsa.get_prime_pool_stats().has_value());
+
+    auto measure = [&rsa] {
+        const auto start = std::chrono::steady_clock::now();
+        rsa.generate_key_pair();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    const double cold = measure();
+
+    const size_t depth = 3;
+    rsa.enable_prime_pool(depth);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (std::chrono::steady_clock::now() < deadline) {
+        const auto [p_stats, q_stats] = *rsa.get_prime_pool_stats();
+        if (p_stats.ready == depth && q_stats.ready == depth) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    const double warm = measure();
+    const auto [p_stats, q_stats] = *rsa.get_prime_pool_stats();
+    EXPECT_EQ(1, p_stats.hits);
+    EXPECT_EQ(1, q_stats.hits);
+    EXPECT_EQ(0, p_stats.misses + q_stats.misses);
+    EXPECT_EQ(depth, p_stats.depth);
+
+    const auto crt = rsa.get_crt_params();
+    ASSERT_TRUE(crt.has_value());
+    EXPECT_EQ(1024, crypto::mp::msb(crt->p) + 1);
+    EXPECT_EQ(1024, crypto::mp::msb(crt->q) + 1);
+    const crypto::big_int message = 0xC0FFEE;
+    EXPECT_EQ(message, rsa.decrypt(rsa.encrypt(message)));
+
+    // пустой пул не блокирует: простые ищутся в вызывающем потоке
+    rsa.enable_prime_pool(1, std::chrono::hours(1));
+    for (int i = 0; i < 3; ++i) rsa.generate_key_pair();
+    const auto [p_after, q_after] = *rsa.get_prime_pool_stats();
+    EXPECT_EQ(3, p_after.hits + p_after.misses);
+    EXPECT_LE(p_after.produced, 1);
+
+    rsa.disable_prime_pool();
+    EXPECT_FALSE(rsa.get_prime_pool_stats().has_value());
+    std::cout << "RSA-2048 key issuance: " << cold << " ms without pool, " << warm << " ms from pool" << std::endl;
+}
+
+TEST(RSABatchTest, DecryptBatchBenchmark2048) {
+    crypto::rsa::RSACryptoService rsa(1024);
+    rsa.generate_key_pair();
+    const auto modulus = rsa.get_public_key().modulus;
+    boost::random::mt19937 gen(31);
+    const boost::random::uniform_int_distribution<crypto::big_int> dist(crypto::big_int(2), modulus - 1);
+    std::vector<crypto::big_int> messages(1000), ciphers;
+    for (auto &message: messages) {
+        message = dist(gen);
+        ciphers.push_back(crypto::math::mod_pow(message, rsa.get_public_key().exponent, modulus));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<crypto::big_int> single;
+    for (const auto &cipher: ciphers) single.push_back(rsa.decrypt(cipher));
+    const std::chrono::duration<double> single_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    const auto batch = rsa.decrypt(std::span<const crypto::big_int>(ciphers));
+    const std::chrono::duration<double> batch_time = std::chrono::steady_clock::now() - start;
+
+    // мелкие пачки: потоки пула не создаются на каждый вызов
+    start = std::chrono::steady_clock::now();
+    std::vector<crypto::big_int> small;
+    for (size_t from = 0; from < ciphers.size(); from += 4) {
+        for (auto &value: rsa.decrypt(std::span<const crypto::big_int>(ciphers).subspan(from, 4))) {
+            small.push_back(std::move(value));
+        }
+    }
+    const std::chrono::duration<double> small_time = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(messages, single);
+    EXPECT_EQ(messages, batch);
+    EXPECT_EQ(messages, small);
+    EXPECT_TRUE(rsa.decrypt(std::span<const crypto::big_int>()).empty());
+    ciphers.push_back(modulus);
+    EXPECT_THROW((void) rsa.decrypt(std::span<const crypto::big_int>(ciphers)), std::invalid_argument);
+
+    std::cout << "RSA-2048 decrypt: single calls " << messages.size() / single_time.count() << " ops/s, batch ("
+            << std::max(1u, std::thread::hardware_concurrency()) << " threads) "
+            << messages.size() / batch_time.count() << " ops/s, batches of 4 " << messages.size() / small_time.count()
+            << " ops/s" << std::endl;
+}
+
+TEST(BigRSACryptoTest, MultiPrime4096) {
+    crypto::rsa::RSACryptoService rsa(2048);
+    const crypto::big_int message = (crypto::big_int(1) << 4000) + 12345;
+    EXPECT_THROW(rsa.set_primes_count(5), std::invalid_argument);
+    for (const size_t primes: {2, 3, 4}) {
+        rsa.set_primes_count(primes);
+        rsa.generate_key_pair();
+        const auto priv_key = rsa.get_priv_key();
+        const auto crt = *rsa.get_crt_params();
+        const size_t modulus_bits = crypto::mp::msb(priv_key.modulus) + 1;
+        // у двух простых p * q может оказаться на бит короче
+        EXPECT_TRUE(modulus_bits == 4096 || (primes == 2 && modulus_bits == 4095)) << modulus_bits;
+        ASSERT_EQ(primes - 2, crt.others.size());
+        crypto::big_int product = crt.p * crt.q;
+        for (const auto &other: crt.others) product *= other.r;
+        EXPECT_EQ(priv_key.modulus, product);
+
+        const auto cipher = rsa.encrypt(message);
+        const size_t rounds = 5;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < rounds; ++i) EXPECT_EQ(message, rsa.decrypt(cipher));
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        rsa.set_parallel_crt(true);
+        EXPECT_EQ(message, rsa.decrypt(cipher));
+        rsa.set_parallel_crt(false);
+        // без CRT тот же закрытый показатель даёт тот же результат
+        rsa.set_private_key(priv_key);
+        EXPECT_EQ(message, rsa.decrypt(cipher));
+        rsa.set_private_key(priv_key, crt);
+
+        std::cout << "RSA-4096 decrypt, " << primes << " primes: " << elapsed.count() / rounds << " ms" << std::endl;
+    }
+
+    const std::filesystem::path plain = "multi_prime_plain.bin", cipher = "multi_prime_cipher.bin",
+            decrypted = "multi_prime_decrypted.bin";
+    std::vector<char> data(10000);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = static_cast<char>(i * 31 + 7);
+    std::ofstream(plain, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+    rsa.encrypt(plain, cipher).get();
+    rsa.decrypt(cipher, decrypted).get();
+    std::ifstream in(decrypted, std::ios::binary);
+    EXPECT_EQ(data, std::vector<char>(std::istreambuf_iterator<char>(in), {}));
+    in.close();
+    for (const auto &path: {plain, cipher, decrypted}) std::filesystem::remove(path);
+}
+
 TEST(BigRSACryptoTest, rsa_4096) {
     crypto::rsa::RSACryptoService rsa_4096(
         crypto::rsa::RSACryptoService::PrimalityTestType::SOLOVAY_STRASSEN, 0.999, 4096);
@@ -1,6 +1,7 @@
 #ifndef BIT_OPERATIONS_H
 #define BIT_OPERATIONS_H
 
+#include <array>
 #include <vector>
 #include <cstdint>
 #include <span>
@@ -27,7 +28,67 @@ namespace crypto::bits {
 
     void set_bit(uint8_t &byte, size_t position, bool value, BitIndexing indexing);
 
-    void shift_left(uint32_t &num, uint8_t shift) noexcept;
+    constexpr void shift_left(uint32_t &num, uint8_t shift) noexcept {
+        num = ((num >> (32 - shift)) | (num << shift)) & ((1 << 28) - 1);
+    }
+
+    /**
+     * Перестановка битов машинного слова (MSB_FIRST, StartBit::ONE).
+     * Входные in_bits битов выровнены по младшему краю data, результат - p_block.size() битов
+     */
+    constexpr uint64_t permute_word(uint64_t data, size_t in_bits, std::span<const uint16_t> p_block) noexcept {
+        uint64_t result = 0;
+        for (const auto pos: p_block) {
+            result = (result << 1) | ((data >> (in_bits - pos)) & 1);
+        }
+        return result;
+    }
+
+    /**
+     * Побайтовая таблица для permute_word: результат перестановки - OR значений table[i][байт i]
+     */
+    template<size_t InBits>
+    using PermutationTable = std::array<std::array<uint64_t, 256>, InBits / 8>;
+
+    template<size_t InBits>
+    constexpr PermutationTable<InBits> make_permutation_table(std::span<const uint16_t> p_block) noexcept {
+        PermutationTable<InBits> table{};
+        for (size_t i = 0; i < InBits / 8; ++i) {
+            for (uint64_t byte = 0; byte < 256; ++byte) {
+                table[i][byte] = permute_word(byte << (InBits - 8 * (i + 1)), InBits, p_block);
+            }
+        }
+        return table;
+    }
+
+    template<size_t InBits>
+    constexpr uint64_t permute_word(uint64_t data, const PermutationTable<InBits> &table) noexcept {
+        uint64_t result = 0;
+        for (size_t i = 0; i < InBits / 8; ++i) {
+            result |= table[i][(data >> (InBits - 8 * (i + 1))) & 0xFF];
+        }
+        return result;
+    }
+
+    /**
+     * Чтение/запись big-endian слова из байтов блока
+     */
+    template<typename T>
+    constexpr T load_be(std::span<const uint8_t> bytes) noexcept {
+        T result{};
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            result = static_cast<T>((result << 8) | bytes[i]);
+        }
+        return result;
+    }
+
+    template<typename T>
+    constexpr void store_be(T value, std::span<uint8_t> bytes) noexcept {
+        for (size_t i = sizeof(T); i-- > 0;) {
+            bytes[i] = static_cast<uint8_t>(value & 0xFF);
+            value >>= 8;
+        }
+    }
 } // crypto::bits
 
 #endif //BIT_OPERATIONS_H
@@ -31,8 +31,4 @@ namespace crypto::bits {
 
         return result;
     }
-
-    void shift_left(uint32_t &num, uint8_t shift) noexcept {
-        num = ((num >> (32 - shift)) | (num << shift)) & ((1 << 28) - 1);
-    }
 }